@@ -10,10 +10,22 @@
  * 2. Sort the two lists
  * 3. Find the sum of the differences of the two lists at each index position
  *
+ * Lists of non-negative numbers are sorted with an LSD radix sort, taking
+ * 11 bits per pass and only as many passes as the largest number needs. The
+ * histograms for every pass are gathered in one read of the list, which is
+ * split across threads for large lists. Anything else falls back to a
+ * comparison sort.
+ *
  * Observation:
  * - Each line is a sequence of five numeric characters, three spaces, then
  *   another sequence of five numeric characters
- * - There are 1000 lines of input
+ * - There are 1000 lines of input, but any number of lines is read
+ *
+ * The input file is memory mapped and rows in the fixed layout above are
+ * decoded with SIMD digit arithmetic (two rows per iteration with AVX2, one
+ * with SSSE3, so compile with -march=native). A row that does not fit the
+ * layout is parsed on its own with std::from_chars, and decoding resumes at
+ * the next row.
  *
  * ## Part 2
  *
@@ -22,6 +34,15 @@
  * 3. Find the sum of each number in the left list multiplied by the number of
  *    times it appears in the right list
  *
+ * The right list is counted once into a frequency table, which is a dense
+ * array of counts when the values span a small enough range and an
+ * open-addressing hash map otherwise. Each left number is then a single
+ * lookup in the table.
+ *
+ * Compiling with BENCHMARK defined instead times the radix sort against the
+ * comparison sort, and the frequency table against the sort and count method,
+ * on generated input of 10^3, 10^6 and 10^7 rows.
+ *
  * ## Answers
  *
  * <details>
@@ -35,6 +56,8 @@
 #define STR(x) #x
 #define STR_LIT(x) STR(x)
 
+#include "share.h"
+
 #include <iostream>
 #include <string>
 #include <cstdlib>
@@ -43,6 +66,22 @@
 #include <tuple>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <array>
+#include <thread>
+#include <string_view>
+#include <charconv>
+#include <optional>
+#include <chrono>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif // __AVX2__ || __SSSE3__
+
+#ifdef BENCHMARK
+#include <random>
+#endif // BENCHMARK
 
 #ifdef PART_TWO
 static constexpr int TEST_ANSWER = 31;
@@ -50,6 +89,10 @@ static constexpr int TEST_ANSWER = 31;
 static constexpr int TEST_ANSWER = 11;
 #endif // PART_TWO
 
+#ifndef ROW_COUNT_HINT
+#define ROW_COUNT_HINT 0
+#endif // !ROW_COUNT_HINT
+
 static constexpr const char * TEST_INPUT = R"(3   4
 4   3
 2   5
@@ -57,64 +100,419 @@ static constexpr const char * TEST_INPUT = R"(3   4
 3   9
 3   3)";
 
-using Stm = std::basic_istream<char>;
+using LinePair = std::tuple<long,long>;
 
-Stm& stmNext(
-    Stm& stream,
-    std::string *str = nullptr,
-    char delim = '\n')
+std::optional<LinePair> stmNextPair(Stm& stream)
 {
-  if (str) str->erase();
-  for (char c{}; stream.get(c); )
-  {
-    if (c == delim) break;
-    if (str) *(str) += c;
+  long left, right;
+  if (!(stream >> left >> right))
+    return std::nullopt;
+
+  stmNext(stream); // advance to next line
+  return LinePair{left, right};
+}
+
+// Reads rows until EOF, returns the number of rows read
+size_t stmReadColumns(Stm& stream, std::vector<int>& left_side, std::vector<int>& right_side, size_t row_count_hint = 0)
+{
+  left_side.reserve(left_side.size() + row_count_hint);
+  right_side.reserve(right_side.size() + row_count_hint);
+
+  size_t rows = 0;
+  for (auto maybe_pair = stmNextPair(stream); maybe_pair; maybe_pair = stmNextPair(stream)) {
+    auto [left, right] = *maybe_pair;
+    left_side.push_back(left);
+    right_side.push_back(right);
+    ++rows;
   }
-  return stream;
+
+  return rows;
 }
 
-using LinePair = std::tuple<long,long>;
+// "NNNNN   NNNNN\n"
+static constexpr size_t FIXED_ROW_WIDTH = 14;
 
-LinePair stmNextPair(Stm& stream)
+// Parses the line at offset with std::from_chars, returns the offset of the
+// next line
+size_t parseColumnsLine(std::string_view sv, size_t offset, std::vector<int>& left_side, std::vector<int>& right_side)
 {
-  long left, right;
-  stream >> left >> right;
-  stmNext(stream); // advance to next line
-  return {left, right};
+  const char *it = sv.data() + offset, *end = sv.data() + sv.size();
+  auto fn_skip_blanks = [&it, end]() {
+    while (it != end && (*it == ' ' || *it == '\t' || *it == '\r'))
+      ++it;
+  };
+
+  int left{}, right{};
+  fn_skip_blanks();
+  auto [it_left_end, ec_left] = std::from_chars(it, end, left);
+  if (ec_left == std::errc()) {
+    it = it_left_end;
+    fn_skip_blanks();
+    auto [it_right_end, ec_right] = std::from_chars(it, end, right);
+    if (ec_right == std::errc()) {
+      it = it_right_end;
+      left_side.push_back(left);
+      right_side.push_back(right);
+    }
+  }
+
+  // advance to next line
+  while (it != end && *it++ != '\n') { }
+  return it - sv.data();
 }
 
-#ifdef PART_TWO
-void progRunPartTwo()
+#if defined(__AVX2__) || defined(__SSSE3__)
+// Digits are gathered into two 8 byte groups, each a 5 digit number behind
+// three zero bytes, then combined pairwise: 10 and 1, 100 and 1, 10000 and 1
+#define FIXED_ROW_SHUFFLE \
+  -1, -1, -1, 0, 1, 2, 3, 4, -1, -1, -1, 8, 9, 10, 11, 12
+#define FIXED_ROW_SEPARATORS \
+  0, 0, 0, 0, 0, ' ', ' ', ' ', 0, 0, 0, 0, 0, '\n', 0, 0
+
+static constexpr int FIXED_ROW_DIGIT_BITS = 0x1F1F;
+static constexpr int FIXED_ROW_SEPARATOR_BITS = 0x20E0;
+#endif // __AVX2__ || __SSSE3__
+
+// Decodes rows in the fixed layout from the start of sv, returns the number of
+// bytes consumed, stopping at the first row not in the layout
+size_t parseColumnsFixed(std::string_view sv, [[maybe_unused]] std::vector<int>& left_side,
+    [[maybe_unused]] std::vector<int>& right_side)
+{
+  [[maybe_unused]] const char *data = sv.data();
+  size_t offset = 0;
+
+#ifdef __AVX2__
+  {
+    const __m256i shuffle = _mm256_setr_epi8(FIXED_ROW_SHUFFLE, FIXED_ROW_SHUFFLE);
+    const __m256i separators = _mm256_setr_epi8(FIXED_ROW_SEPARATORS, FIXED_ROW_SEPARATORS);
+    const __m256i zeros = _mm256_set1_epi8('0');
+    const __m256i nines = _mm256_set1_epi8(9);
+    const __m256i weights_10 = _mm256_setr_epi8(
+        10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+        10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m256i weights_100 = _mm256_setr_epi16(
+        100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1);
+    const __m256i weights_10000 = _mm256_setr_epi16(
+        10000, 1, 10000, 1, 10000, 1, 10000, 1, 10000, 1, 10000, 1, 10000, 1, 10000, 1);
+    const int valid_bits = FIXED_ROW_DIGIT_BITS | (FIXED_ROW_DIGIT_BITS << 16);
+    const int separator_bits = FIXED_ROW_SEPARATOR_BITS | (FIXED_ROW_SEPARATOR_BITS << 16);
+
+    // each 16 byte load reads two bytes past its row
+    while (offset + FIXED_ROW_WIDTH + 16 <= sv.size()) {
+      __m256i rows = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(data + offset))),
+          _mm_loadu_si128((const __m128i *)(data + offset + FIXED_ROW_WIDTH)), 1);
+
+      __m256i digits = _mm256_sub_epi8(rows, zeros);
+      int digit_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(digits, nines), digits));
+      int separator_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(rows, separators));
+      if (((digit_mask & valid_bits) | (separator_mask & separator_bits)) != (valid_bits | separator_bits))
+        break;
+
+      __m256i values = _mm256_shuffle_epi8(digits, shuffle);
+      values = _mm256_maddubs_epi16(values, weights_10);
+      values = _mm256_madd_epi16(values, weights_100);
+      values = _mm256_packs_epi32(values, values);
+      values = _mm256_madd_epi16(values, weights_10000);
+
+      left_side.push_back(_mm256_extract_epi32(values, 0));
+      right_side.push_back(_mm256_extract_epi32(values, 1));
+      left_side.push_back(_mm256_extract_epi32(values, 4));
+      right_side.push_back(_mm256_extract_epi32(values, 5));
+      offset += 2 * FIXED_ROW_WIDTH;
+    }
+  }
+#endif // __AVX2__
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+  {
+    const __m128i shuffle = _mm_setr_epi8(FIXED_ROW_SHUFFLE);
+    const __m128i separators = _mm_setr_epi8(FIXED_ROW_SEPARATORS);
+    const __m128i zeros = _mm_set1_epi8('0');
+    const __m128i nines = _mm_set1_epi8(9);
+    const __m128i weights_10 = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m128i weights_100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+    const __m128i weights_10000 = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+
+    while (offset + 16 <= sv.size()) {
+      __m128i row = _mm_loadu_si128((const __m128i *)(data + offset));
+
+      __m128i digits = _mm_sub_epi8(row, zeros);
+      int digit_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, nines), digits));
+      int separator_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(row, separators));
+      if (((digit_mask & FIXED_ROW_DIGIT_BITS) | (separator_mask & FIXED_ROW_SEPARATOR_BITS))
+          != (FIXED_ROW_DIGIT_BITS | FIXED_ROW_SEPARATOR_BITS))
+        break;
+
+      __m128i values = _mm_shuffle_epi8(digits, shuffle);
+      values = _mm_maddubs_epi16(values, weights_10);
+      values = _mm_madd_epi16(values, weights_100);
+      values = _mm_packs_epi32(values, values);
+      values = _mm_madd_epi16(values, weights_10000);
+
+      uint64_t pair = (uint64_t)_mm_cvtsi128_si64(values);
+      left_side.push_back((int)(uint32_t)pair);
+      right_side.push_back((int)(pair >> 32));
+      offset += FIXED_ROW_WIDTH;
+    }
+  }
+#endif // __AVX2__ || __SSSE3__
+
+  return offset;
+}
+
+void parseColumns(std::string_view sv, std::vector<int>& left_side, std::vector<int>& right_side)
+{
+  left_side.reserve(left_side.size() + sv.size() / FIXED_ROW_WIDTH + 1);
+  right_side.reserve(right_side.size() + sv.size() / FIXED_ROW_WIDTH + 1);
+
+  // a row out of the layout is parsed on its own, then decoding resumes
+  size_t offset = 0;
+  while (offset < sv.size()) {
+    offset += parseColumnsFixed(sv.substr(offset), left_side, right_side);
+    if (offset < sv.size())
+      offset = parseColumnsLine(sv, offset, left_side, right_side);
+  }
+}
+
+// Reads both columns from INPUT_FILE, or the test input, returns false if the
+// input file cannot be read
+bool readColumns(std::vector<int>& left_side, std::vector<int>& right_side)
 {
+#ifdef STREAM_INPUT
 #ifdef INPUT_FILE
   auto stm_input = std::ifstream(STR_LIT(INPUT_FILE));
   if (!stm_input) {
     std::cout << "Unable to read input file\n";
+    return false;
   }
-  size_t count = 1000;
 
 #else // INPUT_FILE
   auto str_storage_test_input = std::string(TEST_INPUT);
   auto stm_input = std::istringstream(str_storage_test_input);
-  size_t count = 6;
 #endif // INPUT_FILE
 
-  auto left_side = std::vector<int>{};
-  auto right_side = std::vector<int>{};
-  for (size_t idx = 0; idx < count; ++idx) {
-    auto [left, right] = stmNextPair(stm_input);
-    left_side.push_back(left);
-    right_side.push_back(right);
+  auto time_start = std::chrono::steady_clock::now();
+  size_t rows = stmReadColumns(stm_input, left_side, right_side, ROW_COUNT_HINT);
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+  std::cout << "Ingested " << rows << " rows in " << seconds * 1000 << " ms ("
+    << (seconds > 0 ? rows / seconds : 0) << " rows/s)\n";
+
+#elif defined(INPUT_FILE)
+  auto mapped_input = MappedFile(STR_LIT(INPUT_FILE));
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+    return false;
   }
 
-  namespace rng = std::ranges;
-  rng::sort(right_side);
+  parseColumns(mapped_input.contents(), left_side, right_side);
+
+#else // STREAM_INPUT
+  parseColumns(TEST_INPUT, left_side, right_side);
+#endif // STREAM_INPUT
+
+  return true;
+}
+
+// values spanning at most this many slots per row are counted densely
+static constexpr size_t FREQ_TABLE_DENSE_SLOTS_PER_ROW = 4;
+static constexpr size_t FREQ_TABLE_DENSE_MIN_SLOTS = 1 << 16;
+
+struct FrequencyTable
+{
+  bool is_dense;
+  int min_value, max_value;
+
+  // dense: counts[value - min_value]
+  // hashed: keys and counts share slots, a count of 0 is an empty slot
+  std::vector<uint32_t> counts;
+  std::vector<int> keys;
+  size_t hash_mask;
+};
+
+inline size_t freqTableHashSlot(const FrequencyTable& table, int value)
+{
+  uint64_t hash = (uint64_t)(uint32_t)value * 0x9E3779B97F4A7C15ull;
+  return (size_t)(hash >> 32) & table.hash_mask;
+}
+
+FrequencyTable freqTableBuild(const std::vector<int>& values)
+{
+  auto table = FrequencyTable{true, 0, -1, {}, {}, 0};
+  if (values.empty())
+    return table;
+
+  auto [it_min, it_max] = std::ranges::minmax_element(values);
+  table.min_value = *it_min;
+  table.max_value = *it_max;
+
+  uint64_t range = (uint64_t)((int64_t)table.max_value - table.min_value) + 1;
+  uint64_t dense_limit = std::max<uint64_t>(FREQ_TABLE_DENSE_MIN_SLOTS,
+      FREQ_TABLE_DENSE_SLOTS_PER_ROW * values.size());
+  table.is_dense = range <= dense_limit;
+
+  if (table.is_dense) {
+    table.counts.assign(range, 0);
+    for (int value: values)
+      ++table.counts[value - table.min_value];
+    return table;
+  }
+
+  // keep the load factor at or below one half
+  size_t capacity = 16;
+  while (capacity < 2 * values.size())
+    capacity <<= 1;
+
+  table.hash_mask = capacity - 1;
+  table.counts.assign(capacity, 0);
+  table.keys.assign(capacity, 0);
+  for (int value: values) {
+    size_t slot = freqTableHashSlot(table, value);
+    while (table.counts[slot] != 0 && table.keys[slot] != value)
+      slot = (slot + 1) & table.hash_mask;
+
+    table.keys[slot] = value;
+    ++table.counts[slot];
+  }
+
+  return table;
+}
+
+inline size_t freqTableCount(const FrequencyTable& table, int value)
+{
+  if (value < table.min_value || value > table.max_value)
+    return 0;
+
+  if (table.is_dense)
+    return table.counts[value - table.min_value];
+
+  size_t slot = freqTableHashSlot(table, value);
+  while (table.counts[slot] != 0) {
+    if (table.keys[slot] == value)
+      return table.counts[slot];
+    slot = (slot + 1) & table.hash_mask;
+  }
+
+  return 0;
+}
+
+long similarityScore(const std::vector<int>& left_side, const std::vector<int>& right_side)
+{
+  auto table = freqTableBuild(right_side);
 
   long answer = 0;
-  for (long left: left_side) {
-    size_t count = rng::count(right_side, left);
-    answer += left * count;
+  for (long left: left_side)
+    answer += left * (long)freqTableCount(table, left);
+
+  return answer;
+}
+
+static constexpr unsigned RADIX_BITS = 11;
+static constexpr size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+static constexpr unsigned RADIX_MAX_PASSES = (31 + RADIX_BITS - 1) / RADIX_BITS;
+
+// below this many rows per thread the histogram is gathered on one thread
+static constexpr size_t RADIX_ROWS_PER_HISTOGRAM_THREAD = 1 << 18;
+
+using RadixHistograms = std::array<std::array<size_t, RADIX_BUCKETS>, RADIX_MAX_PASSES>;
+
+void radixHistogramsAdd(RadixHistograms& histograms, const int *first, const int *last, unsigned passes)
+{
+  for (const int *it = first; it != last; ++it) {
+    uint32_t value = (uint32_t)*it;
+    for (unsigned pass = 0; pass < passes; ++pass)
+      ++histograms[pass][(value >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
   }
+}
+
+RadixHistograms radixHistograms(const std::vector<int>& values, unsigned passes, unsigned thread_count)
+{
+  size_t max_threads = std::max<size_t>(1, values.size() / RADIX_ROWS_PER_HISTOGRAM_THREAD);
+  thread_count = (unsigned)std::clamp<size_t>(thread_count, 1, max_threads);
+
+  auto histograms = RadixHistograms{};
+  if (thread_count == 1) {
+    radixHistogramsAdd(histograms, values.data(), values.data() + values.size(), passes);
+    return histograms;
+  }
+
+  auto thread_histograms = std::vector<RadixHistograms>(thread_count);
+  auto threads = std::vector<std::thread>{};
+  size_t chunk = (values.size() + thread_count - 1) / thread_count;
+  for (unsigned idx_thread = 0; idx_thread < thread_count; ++idx_thread) {
+    size_t begin = std::min(values.size(), idx_thread * chunk);
+    size_t end = std::min(values.size(), begin + chunk);
+    threads.emplace_back(radixHistogramsAdd, std::ref(thread_histograms[idx_thread]),
+        values.data() + begin, values.data() + end, passes);
+  }
+
+  for (auto& thread: threads)
+    thread.join();
+
+  for (const auto& partial: thread_histograms)
+    for (unsigned pass = 0; pass < passes; ++pass)
+      for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        histograms[pass][bucket] += partial[pass][bucket];
+
+  return histograms;
+}
+
+// Sorts with LSD radix passes if every value is non-negative, otherwise
+// returns false and leaves the values untouched
+bool radixSortNonNegative(std::vector<int>& values, unsigned thread_count = 1)
+{
+  if (values.empty())
+    return true;
+
+  auto [it_min, it_max] = std::ranges::minmax_element(values);
+  if (*it_min < 0)
+    return false;
+
+  unsigned passes = 1;
+  while (passes < RADIX_MAX_PASSES && ((uint32_t)*it_max >> (passes * RADIX_BITS)) != 0)
+    ++passes;
+
+  auto histograms = radixHistograms(values, passes, thread_count);
+  auto scratch = std::vector<int>(values.size());
+  for (unsigned pass = 0; pass < passes; ++pass) {
+    auto& histogram = histograms[pass];
+
+    // a pass where every value has the same digit would only copy
+    if (std::ranges::find(histogram, values.size()) != std::end(histogram))
+      continue;
+
+    size_t offset = 0;
+    for (size_t& bucket: histogram) {
+      size_t bucket_size = bucket;
+      bucket = offset;
+      offset += bucket_size;
+    }
+
+    unsigned shift = pass * RADIX_BITS;
+    for (int value: values)
+      scratch[histogram[((uint32_t)value >> shift) & (RADIX_BUCKETS - 1)]++] = value;
+
+    values.swap(scratch);
+  }
+
+  return true;
+}
+
+void columnSort(std::vector<int>& values)
+{
+  if (!radixSortNonNegative(values, std::thread::hardware_concurrency()))
+    std::ranges::sort(values);
+}
+
+#ifdef PART_TWO
+void progRunPartTwo()
+{
+  auto left_side = std::vector<int>{};
+  auto right_side = std::vector<int>{};
+  if (!readColumns(left_side, right_side))
+    return;
+
+  long answer = similarityScore(left_side, right_side);
 
   std::cout << "Answer: " << answer << "\n";
 
@@ -128,33 +526,16 @@ void progRunPartTwo()
 #else //PART_TWO
 void progRunPartOne()
 {
-#ifdef INPUT_FILE
-  auto stm_input = std::ifstream(STR_LIT(INPUT_FILE));
-  if (!stm_input) {
-    std::cout << "Unable to read input file\n";
-  }
-  size_t count = 1000;
-
-#else // INPUT_FILE
-  auto str_storage_test_input = std::string(TEST_INPUT);
-  auto stm_input = std::istringstream(str_storage_test_input);
-  size_t count = 6;
-#endif // INPUT_FILE
-
   auto left_side = std::vector<int>{};
   auto right_side = std::vector<int>{};
-  for (size_t idx = 0; idx < count; ++idx) {
-    auto [left, right] = stmNextPair(stm_input);
-    left_side.push_back(left);
-    right_side.push_back(right);
-  }
+  if (!readColumns(left_side, right_side))
+    return;
 
-  namespace rng = std::ranges;
-  rng::sort(left_side);
-  rng::sort(right_side);
+  columnSort(left_side);
+  columnSort(right_side);
 
   long answer = 0;
-  for (size_t idx = 0; idx < count; ++idx) {
+  for (size_t idx = 0; idx < left_side.size(); ++idx) {
     long left = left_side.at(idx), right = right_side.at(idx);
     answer += std::abs(left - right);
   }
@@ -169,9 +550,97 @@ void progRunPartOne()
 }
 #endif // PART_TWO
 
+#ifdef BENCHMARK
+// the sort and count method is quadratic, so it is not timed past this
+static constexpr size_t BENCHMARK_SORT_COUNT_MAX_ROWS = 100000;
+
+long similarityScoreSortCount(const std::vector<int>& left_side, std::vector<int> right_side)
+{
+  namespace rng = std::ranges;
+  rng::sort(right_side);
+
+  long answer = 0;
+  for (long left: left_side) {
+    size_t count = rng::count(right_side, left);
+    answer += left * count;
+  }
+
+  return answer;
+}
+
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  auto rng_engine = std::mt19937{1};
+  auto dist_five_digit = std::uniform_int_distribution<int>{10000, 99999};
+  auto dist_wide = std::uniform_int_distribution<int>{0, INT_MAX};
+
+  std::cout << "Part 1 sort\n";
+  for (size_t rows: {1000ul, 1000000ul, 10000000ul}) {
+    auto values = std::vector<int>(rows);
+    for (int& value: values)
+      value = dist_five_digit(rng_engine);
+
+    std::cout << rows << " rows, five digit keys\n";
+
+    auto sorted_values = values;
+    auto time_start = Clock::now();
+    std::ranges::sort(sorted_values);
+    std::cout << "  comparison sort: " << fn_millis(Clock::now() - time_start) << " ms\n";
+
+    for (unsigned thread_count: {1u, std::max(2u, std::thread::hardware_concurrency())}) {
+      auto radix_values = values;
+      time_start = Clock::now();
+      radixSortNonNegative(radix_values, thread_count);
+      std::cout << "  radix sort, " << thread_count << " histogram threads: "
+        << fn_millis(Clock::now() - time_start) << " ms ("
+        << (radix_values == sorted_values ? "same" : "DIFFERENT") << ")\n";
+    }
+  }
+
+  std::cout << "Part 2 similarity\n";
+  for (size_t rows: {1000ul, 1000000ul, 10000000ul}) {
+    for (bool is_wide: {false, true}) {
+      auto left_side = std::vector<int>(rows);
+      auto right_side = std::vector<int>(rows);
+      for (size_t idx = 0; idx < rows; ++idx) {
+        left_side[idx] = is_wide ? dist_wide(rng_engine) : dist_five_digit(rng_engine);
+        right_side[idx] = is_wide ? dist_wide(rng_engine) : dist_five_digit(rng_engine);
+      }
+      // give wide rows some matches to find
+      for (size_t idx = 0; idx < rows; idx += 4)
+        right_side[idx] = left_side[idx / 2];
+
+      std::cout << rows << " rows, " << (is_wide ? "wide" : "five digit") << " keys\n";
+
+      auto time_start = Clock::now();
+      long answer = similarityScore(left_side, right_side);
+      std::cout << "  frequency table: " << fn_millis(Clock::now() - time_start)
+        << " ms (" << answer << ")\n";
+
+      if (rows > BENCHMARK_SORT_COUNT_MAX_ROWS) {
+        std::cout << "  sort and count:  skipped\n";
+        continue;
+      }
+
+      time_start = Clock::now();
+      answer = similarityScoreSortCount(left_side, right_side);
+      std::cout << "  sort and count:  " << fn_millis(Clock::now() - time_start)
+        << " ms (" << answer << ")\n";
+    }
+  }
+}
+#endif // BENCHMARK
+
 int main()
 {
-#ifdef PART_TWO
+#ifdef BENCHMARK
+  progRunBenchmark();
+#elif defined(PART_TWO)
   progRunPartTwo();
 #else // PART_TWO
   progRunPartOne();
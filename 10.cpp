@@ -16,7 +16,7 @@
 
 #include "share.h"
 
-#include <fstream>
+#include <spanstream>
 #include <sstream>
 #include <iostream>
 #include <string>
@@ -251,11 +251,12 @@ int main()
   }
 
   {
-    auto stm_file_input = std::ifstream{INPUT_FILE};
-    if (!stm_file_input) {
+    auto mapped_file_input = MappedFile{INPUT_FILE};
+    if (!mapped_file_input.isOpen()) {
       std::cout << "Unable to read input file\n";
       return -1;
     }
+    auto stm_file_input = std::ispanstream{mapped_file_input.contents()};
 
     uint64_t answer = CalculateAnswerPart1(stm_file_input, big_map_size_info);
     std::cout << "Final answer: " << answer << "\n";
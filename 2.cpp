@@ -12,13 +12,31 @@
  * Observations:
  * - Example data has reports of length 5, but actual input uses a varying
  *   length
+ * - Reports are stored back to back in one array of numbers, with a second
+ *   array of offsets to where each report starts, and are tokenised from the
+ *   whole input buffer in one pass
+ * - With AVX2, the differences of eight adjacent pairs are classified at once
+ *   and reduced with masks; the scalar fold is kept as the reference, and the
+ *   test build checks the two agree on random reports
+ * - Compiling with STREAM_INPUT defined instead counts each report as soon as
+ *   its line is tokenised, reading through a fixed size buffer and keeping
+ *   only the current report, then prints bytes per second and peak RSS
+ * - Reports are read until EOF; INPUT_LENGTH_HINT only reserves space for
+ *   them. Compiling with REPORT_INGESTION defined prints the reports
+ *   ingested per second
  *
  * ## Part 2
  *
  * 1. Read input into a list of reports as above
  * 2. Find the number of safe-ish reports. Same conditions as above, also check
  *    if a report is safe if one and only number is dropped
- *  - Do this by heuristically checking every subreport
+ *  - For each direction, find the first adjacent pair that breaks it; only
+ *    dropping one of those two numbers can help, so recheck the report
+ *    skipping each of them in turn
+ *
+ * Compiling with BENCHMARK defined instead times this against checking every
+ * subreport copy, and the classifier against its scalar reference, on
+ * generated reports of length 5 to 1000.
  *
  * ## Answers
  *
@@ -33,15 +51,32 @@
 #include "share.h"
 
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <array>
 #include <ranges>
 #include <algorithm>
+#include <span>
+
+#if defined(REPORT_INGESTION) || defined(BENCHMARK) || defined(STREAM_INPUT)
+#include <chrono>
+#endif // REPORT_INGESTION || BENCHMARK || STREAM_INPUT
+
+#ifdef STREAM_INPUT
+#include <sstream>
+#include <sys/resource.h>
+#endif // STREAM_INPUT
+
+#if !defined(USE_INPUT_FILE) || defined(BENCHMARK)
+#include <random>
+#endif // !USE_INPUT_FILE || BENCHMARK
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif // __AVX2__
 
 #ifdef USE_INPUT_FILE
 static constexpr const char * INPUT_FILE = "2.txt";
-static constexpr const size_t INPUT_LENGTH = 1000;
+static constexpr const size_t INPUT_LENGTH_HINT = 1000;
 
 #else // USE_INPUT_FILE
 static constexpr const char * TEST_INPUT = R"(7 6 4 2 1
@@ -51,7 +86,7 @@ static constexpr const char * TEST_INPUT = R"(7 6 4 2 1
 8 6 4 4 1
 1 3 6 7 9)";
 
-static constexpr const size_t INPUT_LENGTH = 6;
+static constexpr const size_t INPUT_LENGTH_HINT = 6;
 
 #ifdef PART_TWO
 static constexpr const long TEST_ANSWER = 4;
@@ -61,7 +96,87 @@ static constexpr const long TEST_ANSWER = 2;
 
 #endif // USE_INPUT_FILE
 
-using Report = std::vector<long>;
+using Report = std::span<const int32_t>;
+
+// Report idx is values[offsets[idx]] up to values[offsets[idx + 1]]
+struct Reports
+{
+  std::vector<int32_t> values;
+  std::vector<size_t> offsets{0};
+};
+
+size_t reportsCount(const Reports& reports)
+{
+  return reports.offsets.size() - 1;
+}
+
+Report reportsAt(const Reports& reports, size_t idx)
+{
+  return {reports.values.data() + reports.offsets[idx], reports.values.data() + reports.offsets[idx + 1]};
+}
+
+// Ends the report being added to, unless it has no numbers
+void reportsEndReport(Reports& reports)
+{
+  if (reports.values.size() != reports.offsets.back())
+    reports.offsets.push_back(reports.values.size());
+}
+
+// Tokeniser state carried between buffers of input
+struct ReportTokeniser
+{
+  int32_t value = 0;
+  bool is_in_value = false, is_negative = false;
+};
+
+// Calls fn_value for each number and fn_end_line at each newline
+template <class Fn_Value, class Fn_End_Line>
+void reportTokeniserFeed(ReportTokeniser& tokeniser, std::string_view sv, Fn_Value fn_value, Fn_End_Line fn_end_line)
+{
+  auto& [value, is_in_value, is_negative] = tokeniser;
+  for (char ch: sv) {
+    if (ch >= '0' && ch <= '9') {
+      value = value * 10 + (ch - '0');
+      is_in_value = true;
+      continue;
+    }
+
+    if (is_in_value)
+      fn_value(is_negative ? -value : value);
+
+    value = 0;
+    is_in_value = false;
+    is_negative = ch == '-';
+    if (ch == '\n')
+      fn_end_line();
+  }
+}
+
+// Ends the input, which may not end with a newline
+template <class Fn_Value, class Fn_End_Line>
+void reportTokeniserFinish(ReportTokeniser& tokeniser, Fn_Value fn_value, Fn_End_Line fn_end_line)
+{
+  if (tokeniser.is_in_value)
+    fn_value(tokeniser.is_negative ? -tokeniser.value : tokeniser.value);
+
+  tokeniser = {};
+  fn_end_line();
+}
+
+Reports reportsParse(std::string_view sv, size_t report_count_hint = 0)
+{
+  auto reports = Reports{};
+  reports.values.reserve(sv.size() / 2);
+  reports.offsets.reserve(report_count_hint + 1);
+
+  auto fn_value = [&reports](int32_t value) { reports.values.push_back(value); };
+  auto fn_end_line = [&reports]() { reportsEndReport(reports); };
+
+  auto tokeniser = ReportTokeniser{};
+  reportTokeniserFeed(tokeniser, sv, fn_value, fn_end_line);
+  reportTokeniserFinish(tokeniser, fn_value, fn_end_line);
+  return reports;
+}
 
 enum ReportCondition {
   SAFE_INCREASING, SAFE_DECREASING, UNSAFE
@@ -79,31 +194,192 @@ ReportCondition reportAdjacentPairCondition(int first, int second)
       );
 }
 
-int main()
+// Reports with fewer than two numbers have no pairs and count as increasing
+ReportCondition reportConditionScalar(Report report)
 {
-#ifdef USE_INPUT_FILE
-  auto stm_input = std::ifstream(INPUT_FILE);
-  if (!stm_input) {
-    std::cout << "Unable to read input file\n";
+  namespace view = std::views;
+  namespace rng = std::ranges;
+
+  auto fn_pair_condition = [](auto&& r) -> ReportCondition {
+    return reportAdjacentPairCondition(r[0], r[1]);
+  };
+
+  auto fn_fold_report_condition = [](ReportCondition a, ReportCondition b) -> ReportCondition {
+    return a == b ? a : UNSAFE;
+  };
+
+  auto report_conditions = report | view::slide(2) | view::transform(fn_pair_condition);
+  return rng::fold_left_first(report_conditions, fn_fold_report_condition).value_or(SAFE_INCREASING);
+}
+
+#ifdef __AVX2__
+ReportCondition reportConditionAvx2(Report report)
+{
+  const int32_t *data = report.data();
+  size_t pair_count = report.size() < 2 ? 0 : report.size() - 1;
+
+  const __m256i lane_idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i all_set = _mm256_set1_epi32(-1);
+  __m256i is_increasing = all_set, is_decreasing = all_set;
+  for (size_t idx = 0; idx < pair_count; idx += 8) {
+    // lanes past the last pair load nothing and are ignored
+    __m256i is_lane_used = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)std::min<size_t>(8, pair_count - idx)), lane_idx);
+    __m256i first = _mm256_maskload_epi32(data + idx, is_lane_used);
+    __m256i second = _mm256_maskload_epi32(data + idx + 1, is_lane_used);
+    __m256i difference = _mm256_sub_epi32(second, first);
+    __m256i is_lane_unused = _mm256_andnot_si256(is_lane_used, all_set);
+
+    __m256i is_step_up = _mm256_and_si256(
+        _mm256_cmpgt_epi32(difference, _mm256_set1_epi32(0)),
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(4), difference));
+    __m256i is_step_down = _mm256_and_si256(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(0), difference),
+        _mm256_cmpgt_epi32(difference, _mm256_set1_epi32(-4)));
+
+    is_increasing = _mm256_and_si256(is_increasing, _mm256_or_si256(is_step_up, is_lane_unused));
+    is_decreasing = _mm256_and_si256(is_decreasing, _mm256_or_si256(is_step_down, is_lane_unused));
+    if (_mm256_testz_si256(_mm256_or_si256(is_increasing, is_decreasing), all_set))
+      return UNSAFE;
   }
 
-#else // USE_INPUT_FILE
-  auto str_storage_test_input = std::string(TEST_INPUT);
-  auto stm_input = std::istringstream(str_storage_test_input);
-#endif // USE_INPUT_FILE
+  if (_mm256_movemask_epi8(is_increasing) == -1)
+    return SAFE_INCREASING;
+
+  if (_mm256_movemask_epi8(is_decreasing) == -1)
+    return SAFE_DECREASING;
+
+  return UNSAFE;
+}
+#endif // __AVX2__
+
+ReportCondition reportCondition(Report report)
+{
+#ifdef __AVX2__
+  return reportConditionAvx2(report);
+#else // __AVX2__
+  return reportConditionScalar(report);
+#endif // __AVX2__
+}
+
+#ifndef USE_INPUT_FILE
+bool testReportConditionMatchesScalar()
+{
+  auto rng_engine = std::mt19937{7};
+  auto dist_length = std::uniform_int_distribution<size_t>{0, 40};
+  auto dist_step = std::uniform_int_distribution<int32_t>{-5, 5};
+
+  for (int trial = 0; trial < 100000; ++trial) {
+    // mostly monotonic, so both safe and unsafe reports come up
+    auto values = std::vector<int32_t>(dist_length(rng_engine));
+    int32_t direction = trial % 2 ? 1 : -1;
+    int32_t value = 1000;
+    for (auto& v: values) {
+      v = value;
+      int32_t step = dist_step(rng_engine);
+      value += trial % 3 ? direction * (std::abs(step) % 3 + 1) : step;
+    }
+
+    auto report = Report{values};
+    if (reportCondition(report) != reportConditionScalar(report))
+      return false;
+  }
+
+  return true;
+}
+#endif // !USE_INPUT_FILE
+
+static constexpr size_t REPORT_NO_SKIP = SIZE_MAX;
 
-  auto reports = std::vector<Report>{};
-  for (size_t idx = 0; idx < INPUT_LENGTH; ++idx) {
-    auto line = std::string{};
-    stmNext(stm_input, &line);
-    auto stm_line = std::istringstream(line);
+// Index of the first number whose pair with the next number does not have the
+// given condition, ignoring the number at skip; report.size() if all do
+size_t reportFirstViolation(Report report, ReportCondition condition, size_t skip = REPORT_NO_SKIP)
+{
+  size_t idx_prev = skip == 0 ? 1 : 0;
+  for (size_t idx = idx_prev + 1; idx < report.size(); ++idx) {
+    if (idx == skip)
+      continue;
+
+    if (reportAdjacentPairCondition(report[idx_prev], report[idx]) != condition)
+      return idx_prev;
+
+    idx_prev = idx;
+  }
+
+  return report.size();
+}
+
+bool reportIsSafeWithDampener(Report report)
+{
+  for (ReportCondition condition: {SAFE_INCREASING, SAFE_DECREASING}) {
+    size_t idx_violation = reportFirstViolation(report, condition);
+    if (idx_violation == report.size())
+      return true;
+
+    // the violating pair survives dropping any other number
+    if (reportFirstViolation(report, condition, idx_violation) == report.size())
+      return true;
+
+    if (reportFirstViolation(report, condition, idx_violation + 1) == report.size())
+      return true;
+  }
+
+  return false;
+}
+
+bool reportIsCounted(Report report)
+{
+#ifdef PART_TWO
+  return reportIsSafeWithDampener(report);
+#else // PART_TWO
+  return reportCondition(report) != UNSAFE;
+#endif // PART_TWO
+}
+
+#ifdef STREAM_INPUT
+#ifndef STREAM_BUFFER_SIZE
+#define STREAM_BUFFER_SIZE (1 << 16)
+#endif // !STREAM_BUFFER_SIZE
 
-    auto& report = reports.emplace_back();
-    long value;
-    while (stm_line >> value)
-      report.push_back(value);
+// Counts reports as each line is tokenised, holding only the read buffer and
+// the report being read
+long streamCountReports(Stm& stream)
+{
+  auto time_start = std::chrono::steady_clock::now();
+
+  long count = 0;
+  size_t byte_count = 0;
+  auto report = std::vector<int32_t>{};
+  auto fn_value = [&report](int32_t value) { report.push_back(value); };
+  auto fn_end_line = [&report, &count]() {
+    if (!report.empty() && reportIsCounted(report))
+      ++count;
+    report.clear();
+  };
+
+  auto tokeniser = ReportTokeniser{};
+  static char buffer[STREAM_BUFFER_SIZE];
+  while (stream.read(buffer, sizeof buffer) || stream.gcount() > 0) {
+    size_t read_count = stream.gcount();
+    byte_count += read_count;
+    reportTokeniserFeed(tokeniser, {buffer, read_count}, fn_value, fn_end_line);
   }
 
+  reportTokeniserFinish(tokeniser, fn_value, fn_end_line);
+
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+  auto usage = rusage{};
+  getrusage(RUSAGE_SELF, &usage);
+  std::cout << "Streamed " << byte_count << " bytes in " << seconds * 1000 << " ms ("
+    << (seconds > 0 ? byte_count / seconds / 1e6 : 0) << " MB/s), peak RSS "
+    << usage.ru_maxrss << " KB\n";
+
+  return count;
+}
+#endif // STREAM_INPUT
+
+#ifdef BENCHMARK
+bool reportIsSafeWithDampenerByCopies(Report report)
+{
   namespace view = std::views;
   namespace rng = std::ranges;
 
@@ -115,37 +391,133 @@ int main()
     return a == b ? a : UNSAFE;
   };
 
-#ifdef PART_TWO
+  for (size_t idx = 0; idx < report.size(); ++idx) {
+    auto report_copy = std::vector<int32_t>(std::begin(report), std::end(report));
+    report_copy.erase(std::begin(report_copy) + idx);
+    auto report_conditions = report_copy | view::slide(2) | view::transform(fn_pair_condition);
+    auto maybe_condition = rng::fold_left_first(report_conditions, fn_fold_report_condition);
+    if (maybe_condition.value() != UNSAFE)
+      return true;
+  }
 
-  long answer = 0;
-  for (const auto& report: reports) {
-    bool is_report_safeish = false;
-    for (size_t idx = 0; idx < report.size(); ++idx) {
-      Report report_copy(report);
-      report_copy.erase(std::begin(report_copy) + idx);
-      auto report_conditions = report_copy | view::slide(2) | view::transform(fn_pair_condition);
-      auto maybe_condition = rng::fold_left_first(report_conditions, fn_fold_report_condition);
-      if (maybe_condition.value() != UNSAFE) {
-        is_report_safeish = true;
-        break;
+  return false;
+}
+
+// elements generated per report length, shared between the reports
+static constexpr size_t BENCHMARK_ELEMENTS = 200000;
+
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  auto rng_engine = std::mt19937{2};
+  auto dist_step = std::uniform_int_distribution<int32_t>{1, 3};
+  auto dist_fault = std::uniform_int_distribution<int32_t>{-5, 5};
+
+  for (size_t length: {5ul, 10ul, 100ul, 1000ul}) {
+    // monotonic walks with up to two numbers disturbed
+    auto reports = Reports{};
+    for (size_t idx_report = 0; idx_report < BENCHMARK_ELEMENTS / length; ++idx_report) {
+      int32_t direction = rng_engine() % 2 ? 1 : -1;
+      int32_t value = 10000;
+      for (size_t idx = 0; idx < length; ++idx) {
+        reports.values.push_back(value);
+        value += direction * dist_step(rng_engine);
       }
+
+      for (int fault = rng_engine() % 3; fault > 0; --fault)
+        reports.values[reports.offsets.back() + rng_engine() % length] += dist_fault(rng_engine);
+
+      reportsEndReport(reports);
     }
 
-    if (is_report_safeish)
-      ++answer;
+    std::cout << reportsCount(reports) << " reports of length " << length << "\n";
+
+    auto time_start = Clock::now();
+    long safe_count = 0;
+    for (size_t idx = 0; idx < reportsCount(reports); ++idx)
+      safe_count += reportIsSafeWithDampener(reportsAt(reports, idx));
+    std::cout << "  single pass:       " << fn_millis(Clock::now() - time_start)
+      << " ms (" << safe_count << " safe)\n";
+
+    time_start = Clock::now();
+    safe_count = 0;
+    for (size_t idx = 0; idx < reportsCount(reports); ++idx)
+      safe_count += reportIsSafeWithDampenerByCopies(reportsAt(reports, idx));
+    std::cout << "  subreport copies:  " << fn_millis(Clock::now() - time_start)
+      << " ms (" << safe_count << " safe)\n";
+
+    time_start = Clock::now();
+    safe_count = 0;
+    for (size_t idx = 0; idx < reportsCount(reports); ++idx)
+      safe_count += reportCondition(reportsAt(reports, idx)) != UNSAFE;
+    std::cout << "  classifier:        " << fn_millis(Clock::now() - time_start)
+      << " ms (" << safe_count << " strictly safe)\n";
+
+    time_start = Clock::now();
+    safe_count = 0;
+    for (size_t idx = 0; idx < reportsCount(reports); ++idx)
+      safe_count += reportConditionScalar(reportsAt(reports, idx)) != UNSAFE;
+    std::cout << "  scalar classifier: " << fn_millis(Clock::now() - time_start)
+      << " ms (" << safe_count << " strictly safe)\n";
   }
+}
+#endif // BENCHMARK
 
-#else // PART_TWO
+int main()
+{
+#ifdef BENCHMARK
+  progRunBenchmark();
+  return 0;
+#endif // BENCHMARK
+
+#ifdef STREAM_INPUT
+#ifdef USE_INPUT_FILE
+  auto stm_input = std::ifstream(INPUT_FILE);
+  if (!stm_input) {
+    std::cout << "Unable to read input file\n";
+  }
+
+#else // USE_INPUT_FILE
+  auto stm_input = std::istringstream(std::string(TEST_INPUT));
+#endif // USE_INPUT_FILE
+
+  long answer = streamCountReports(stm_input);
+
+#else // STREAM_INPUT
+#ifdef REPORT_INGESTION
+  auto time_start = std::chrono::steady_clock::now();
+#endif // REPORT_INGESTION
+
+#ifdef USE_INPUT_FILE
+  auto mapped_input = MappedFile(INPUT_FILE);
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+  }
+
+  auto str_input = mapped_input.contents();
+
+#else // USE_INPUT_FILE
+  auto str_input = std::string_view(TEST_INPUT);
+#endif // USE_INPUT_FILE
+
+  auto reports = reportsParse(str_input, INPUT_LENGTH_HINT);
+
+#ifdef REPORT_INGESTION
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+  std::cout << "Ingested " << reportsCount(reports) << " reports in " << seconds * 1000 << " ms ("
+    << (seconds > 0 ? reportsCount(reports) / seconds : 0) << " reports/s)\n";
+#endif // REPORT_INGESTION
 
   long answer = 0;
-  for (auto &report: reports) {
-    auto report_conditions = report | view::slide(2) | view::transform(fn_pair_condition);
-    auto maybe_condition = rng::fold_left_first(report_conditions, fn_fold_report_condition);
-    if (maybe_condition.value() != UNSAFE)
+  for (size_t idx = 0; idx < reportsCount(reports); ++idx) {
+    if (reportIsCounted(reportsAt(reports, idx)))
       ++answer;
   }
-
-#endif // PART_TWO
+#endif // STREAM_INPUT
 
   std::cout << "Answer: " << answer << "\n";
 
@@ -154,6 +526,11 @@ int main()
       ? "Test succeeded\n"
       : "Test failed\n"
       );
+
+  std::cout << (testReportConditionMatchesScalar()
+      ? "Classifier test succeeded\n"
+      : "Classifier test failed\n"
+      );
 #endif // !USE_INPUT_FILE
 }
 
@@ -5,7 +5,7 @@
  * ## Part 1
  *
  * 1. Parse the input into a sequence of valid tokens `mul(XX,YY)` where XX and
- *    YY are an n-lenth sequence of numeric characters
+ *    YY are sequences of one to three numeric characters
  * 2. Take the sum of all the multiplications
  *
  * Observations:
@@ -17,6 +17,30 @@
  * 1. Same as above, handling extra tokens `do()` and `don't` which enable and
  *    disable multiplication respectively
  *
+ * Between tokens the input is scanned 16 bytes at a time for the only
+ * characters a token can start with, `m` and `d`, so the state machine only
+ * sees candidate positions.
+ *
+ * Operands are accumulated as integers while their digits are read. The
+ * sequential parse runs on a transition table generated at compile time: a
+ * DFA over every prefix of `mul(a,b)`, `do()` and `don't()`, whose
+ * transitions also say when to add an operand digit or a product. Compiling
+ * with BENCHMARK defined times it against the switch based state machine on
+ * generated noisy input.
+ *
+ * Compiling with PARALLEL defined splits the input into PARALLEL_CHUNKS
+ * chunks (one per core by default), which PARALLEL_THREADS threads (also one
+ * per core by default) take in turn. Each chunk is parsed from every state
+ * the parser can be in between tokens: looking for a token, and disabled
+ * waiting for `do()`. The chunks are then stitched in order: the true parser
+ * state at the start of a chunk is stepped forward, which also finishes any
+ * number split across the boundary, until it meets a state one of the
+ * speculative parses passed through at the same position, then takes that
+ * parse's result for the rest of the chunk. The answer is identical to the
+ * sequential scan. Skipping between tokens stops at the end of the chunk, and
+ * the test build checks that input without tokens costs about as much in a
+ * thousand chunks as in one.
+ *
  * ## Answers
  *
  * <details>
@@ -29,11 +53,29 @@
 
 #include "share.h"
 
-#include <fstream>
-#include <sstream>
 #include <utility>
 #include <string>
 #include <string_view>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#if defined(PARALLEL) || defined(BENCHMARK)
+#include <chrono>
+#endif // PARALLEL || BENCHMARK
+
+#ifdef PARALLEL
+#include <atomic>
+#include <thread>
+#endif // PARALLEL
+
+#ifdef BENCHMARK
+#include <random>
+#endif // BENCHMARK
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
 
 #ifdef USE_INPUT_FILE
 static constexpr const char * INPUT_FILE = "3.txt";
@@ -57,117 +99,503 @@ enum ParserState {
 #endif //PART_TWO
 };
 
-int main()
+// Index of the first of ch1 or ch2 in sv from pos up to end, or end if neither
+size_t svFindEither(std::string_view sv, size_t pos, size_t end, char ch1, char ch2)
 {
-#ifdef USE_INPUT_FILE
-  std::string str_input{};
-  {
-    auto stm_file_input = std::ifstream(INPUT_FILE);
-    if (!stm_file_input) {
-      std::cout << "Unable to read input file\n";
-    }
-
-    for (char c{}; stm_file_input.get(c); ) {
-      str_input.push_back(c);
-    }
+#ifdef __SSE2__
+  const __m128i v_ch1 = _mm_set1_epi8(ch1);
+  const __m128i v_ch2 = _mm_set1_epi8(ch2);
+  for ( ; pos + 16 <= end; pos += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(sv.data() + pos));
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, v_ch1), _mm_cmpeq_epi8(bytes, v_ch2)));
+    if (mask != 0)
+      return pos + __builtin_ctz(mask);
   }
+#endif // __SSE2__
 
-#else // USE_INPUT_FILE
-  auto str_input = std::string(TEST_INPUT);
-#endif // USE_INPUT_FILE
+  for ( ; pos < end; ++pos)
+    if (sv[pos] == ch1 || sv[pos] == ch2)
+      return pos;
 
-  long answer = 0;
+  return end;
+}
 
-  using namespace std::literals::string_view_literals;
+using namespace std::literals::string_view_literals;
 #ifdef PART_TWO
-  auto sv_do_token    = "do()"sv;
-  auto sv_dont_token  = "don't()"sv;
+static constexpr auto sv_do_token    = "do()"sv;
+static constexpr auto sv_dont_token  = "don't()"sv;
 #endif // PART_TWO
-  auto sv_start_token = "mul("sv;
-  auto ch_delimiter = ',';
-  auto ch_end_token  = ')';
+static constexpr auto sv_start_token = "mul("sv;
+static constexpr char ch_delimiter = ',';
+static constexpr char ch_end_token = ')';
+static constexpr int OPERAND_MAX_DIGITS = 3;
 
-  auto it_parser = str_input.begin();
-  auto val1 = std::string{};
-  auto val2 = std::string{};
-  ParserState state = START_TOKEN;
-  while (it_parser != str_input.end()) {
-    switch (state) {
-      case START_TOKEN:
-        {
+// first characters of tokens, the scanner skips to these
+static constexpr char ch_mul_start = sv_start_token.front();
 #ifdef PART_TWO
-          auto vw_token = std::string_view(it_parser, it_parser + sv_dont_token.length());
+static constexpr char ch_do_start = sv_do_token.front();
 #else // PART_TWO
-          auto vw_token = std::string_view(it_parser, it_parser + sv_start_token.length());
-#endif // PART_TWO
-          if (vw_token.starts_with(sv_start_token)) {
-            state = FIRST_VALUE;
-            it_parser += sv_start_token.length();
-          }
-#ifdef PART_TWO
-          else if (vw_token.starts_with(sv_dont_token)) {
-            state = ENABLE_TOKEN;
-            it_parser += sv_dont_token.length();
-          }
+static constexpr char ch_do_start = ch_mul_start;
 #endif // PART_TWO
-          else {
-            ++it_parser;
-          }
+
+struct Parser
+{
+  ParserState state = START_TOKEN;
+  size_t pos = 0;
+  long val1 = 0, val2 = 0;
+  int val1_digits = 0, val2_digits = 0;
+  long answer = 0;
+};
+
+// Token view at pos, clamped to the end of the input
+std::string_view svTokenAt(std::string_view sv, size_t pos, size_t length)
+{
+  return sv.substr(pos, std::min(length, sv.size() - pos));
+}
+
+void parserReset(Parser& parser)
+{
+  parser.val1 = parser.val2 = 0;
+  parser.val1_digits = parser.val2_digits = 0;
+  parser.state = START_TOKEN;
+}
+
+// Runs one transition of the state machine from parser.pos, which must be
+// before end; skipping to the next candidate token start is its own step and
+// stops at end, while a token may still be read past it
+void parserStep(Parser& parser, std::string_view sv, size_t end)
+{
+  switch (parser.state) {
+    case START_TOKEN:
+      {
+        if (sv[parser.pos] != ch_mul_start && sv[parser.pos] != ch_do_start) {
+          parser.pos = svFindEither(sv, parser.pos, end, ch_mul_start, ch_do_start);
           break;
         }
-      case FIRST_VALUE:
-        if (std::isdigit(*it_parser)) {
-          val1.push_back(*it_parser);
-          ++it_parser;
+
+#ifdef PART_TWO
+        auto vw_token = svTokenAt(sv, parser.pos, sv_dont_token.length());
+#else // PART_TWO
+        auto vw_token = svTokenAt(sv, parser.pos, sv_start_token.length());
+#endif // PART_TWO
+        if (vw_token.starts_with(sv_start_token)) {
+          parser.state = FIRST_VALUE;
+          parser.pos += sv_start_token.length();
         }
-        else if (*it_parser == ch_delimiter) {
-          state = SECOND_VALUE;
-          ++it_parser;
+#ifdef PART_TWO
+        else if (vw_token.starts_with(sv_dont_token)) {
+          parser.state = ENABLE_TOKEN;
+          parser.pos += sv_dont_token.length();
         }
+#endif // PART_TWO
         else {
-          val1.clear();
-          state = START_TOKEN;
-          ++it_parser;
+          ++parser.pos;
         }
         break;
+      }
+
+    case FIRST_VALUE:
+      if (std::isdigit(sv[parser.pos]) && parser.val1_digits < OPERAND_MAX_DIGITS) {
+        parser.val1 = parser.val1 * 10 + (sv[parser.pos] - '0');
+        ++parser.val1_digits;
+      }
+      else if (sv[parser.pos] == ch_delimiter && parser.val1_digits != 0) {
+        parser.state = SECOND_VALUE;
+      }
+      else {
+        parserReset(parser);
+      }
+      ++parser.pos;
+      break;
 
-      case SECOND_VALUE:
-        if (std::isdigit(*it_parser)) {
-          val2.push_back(*it_parser);
-          ++it_parser;
+    case SECOND_VALUE:
+      if (std::isdigit(sv[parser.pos]) && parser.val2_digits < OPERAND_MAX_DIGITS) {
+        parser.val2 = parser.val2 * 10 + (sv[parser.pos] - '0');
+        ++parser.val2_digits;
+      }
+      else if (sv[parser.pos] == ch_end_token && parser.val2_digits != 0) {
+        parser.answer += parser.val1 * parser.val2;
+        parserReset(parser);
+      }
+      else {
+        parserReset(parser);
+      }
+      ++parser.pos;
+      break;
+
+#ifdef PART_TWO
+    case ENABLE_TOKEN:
+      {
+        if (sv[parser.pos] != ch_do_start) {
+          parser.pos = svFindEither(sv, parser.pos, end, ch_do_start, ch_do_start);
+          break;
         }
-        else if (*it_parser == ch_end_token) {
-          answer += std::stol(val1) * std::stol(val2);
-          val1.clear();
-          val2.clear();
-          state = START_TOKEN;
-          ++it_parser;
+
+        if (svTokenAt(sv, parser.pos, sv_do_token.length()).starts_with(sv_do_token)) {
+          parser.state = START_TOKEN;
+          parser.pos += sv_do_token.length();
         }
         else {
-          val1.clear();
-          val2.clear();
-          state = START_TOKEN;
-          ++it_parser;
+          ++parser.pos;
         }
         break;
+      }
+#endif // PART_TWO
+  }
+}
 
+enum DfaState : uint8_t {
+  DFA_START, DFA_M, DFA_MU, DFA_MUL,
+  DFA_FIRST_VALUE, // + digits read, up to OPERAND_MAX_DIGITS
+  DFA_SECOND_VALUE = DFA_FIRST_VALUE + OPERAND_MAX_DIGITS + 1,
+  DFA_SECOND_VALUE_END = DFA_SECOND_VALUE + OPERAND_MAX_DIGITS,
 #ifdef PART_TWO
-      case ENABLE_TOKEN:
-        {
-          auto sv_token = std::string_view(it_parser, it_parser + sv_do_token.length());
-          if (sv_token.starts_with(sv_do_token)) {
-            state = START_TOKEN;
-            it_parser += sv_do_token.length();
-          }
-          else {
-            ++it_parser;
-          }
-          break;
-        }
+  DFA_D, DFA_DO, DFA_DON, DFA_DON_QUOTE, DFA_DONT, DFA_DONT_OPEN,
+  DFA_DISABLED, DFA_DISABLED_D, DFA_DISABLED_DO, DFA_DISABLED_DO_OPEN,
+#endif // PART_TWO
+  DFA_STATE_COUNT
+};
+
+enum DfaAction : uint8_t { DFA_NONE, DFA_FIRST_DIGIT, DFA_SECOND_DIGIT, DFA_MULTIPLY };
+
+struct DfaTransition
+{
+  DfaState next;
+  DfaAction action;
+};
+
+using DfaTable = std::array<std::array<DfaTransition, 256>, DFA_STATE_COUNT>;
+
+constexpr DfaTable dfaBuildTable()
+{
+  DfaTable table{};
+  auto fn_set = [&table](int state, char ch, int next, DfaAction action = DFA_NONE) {
+    table[state][(unsigned char)ch] = {(DfaState)next, action};
+  };
+
+  // token prefixes restart from the character that broke them, while a
+  // broken operand or operator swallows it
+  auto fn_restart = [&table](int state, int restart_state) {
+    for (int ch = 0; ch < 256; ++ch)
+      table[state][ch] = table[restart_state][ch];
+  };
+
+  for (int ch = 0; ch < 256; ++ch)
+    table[DFA_START][ch] = {DFA_START, DFA_NONE};
+
+  fn_set(DFA_START, 'm', DFA_M);
+#ifdef PART_TWO
+  fn_set(DFA_START, 'd', DFA_D);
+#endif // PART_TWO
+
+  fn_restart(DFA_M, DFA_START);
+  fn_set(DFA_M, 'u', DFA_MU);
+  fn_restart(DFA_MU, DFA_START);
+  fn_set(DFA_MU, 'l', DFA_MUL);
+  fn_restart(DFA_MUL, DFA_START);
+  fn_set(DFA_MUL, '(', DFA_FIRST_VALUE);
+
+  for (int digits = 0; digits <= OPERAND_MAX_DIGITS; ++digits) {
+    for (char digit = '0'; digit <= '9' && digits < OPERAND_MAX_DIGITS; ++digit) {
+      fn_set(DFA_FIRST_VALUE + digits, digit, DFA_FIRST_VALUE + digits + 1, DFA_FIRST_DIGIT);
+      fn_set(DFA_SECOND_VALUE + digits, digit, DFA_SECOND_VALUE + digits + 1, DFA_SECOND_DIGIT);
+    }
+
+    if (digits != 0) {
+      fn_set(DFA_FIRST_VALUE + digits, ch_delimiter, DFA_SECOND_VALUE);
+      fn_set(DFA_SECOND_VALUE + digits, ch_end_token, DFA_START, DFA_MULTIPLY);
+    }
+  }
+
+#ifdef PART_TWO
+  fn_restart(DFA_D, DFA_START);
+  fn_set(DFA_D, 'o', DFA_DO);
+  fn_restart(DFA_DO, DFA_START);
+  fn_set(DFA_DO, 'n', DFA_DON);
+  fn_restart(DFA_DON, DFA_START);
+  fn_set(DFA_DON, '\'', DFA_DON_QUOTE);
+  fn_restart(DFA_DON_QUOTE, DFA_START);
+  fn_set(DFA_DON_QUOTE, 't', DFA_DONT);
+  fn_restart(DFA_DONT, DFA_START);
+  fn_set(DFA_DONT, '(', DFA_DONT_OPEN);
+  fn_restart(DFA_DONT_OPEN, DFA_START);
+  fn_set(DFA_DONT_OPEN, ')', DFA_DISABLED);
+
+  for (int ch = 0; ch < 256; ++ch)
+    table[DFA_DISABLED][ch] = {DFA_DISABLED, DFA_NONE};
+
+  fn_set(DFA_DISABLED, 'd', DFA_DISABLED_D);
+  fn_restart(DFA_DISABLED_D, DFA_DISABLED);
+  fn_set(DFA_DISABLED_D, 'o', DFA_DISABLED_DO);
+  fn_restart(DFA_DISABLED_DO, DFA_DISABLED);
+  fn_set(DFA_DISABLED_DO, '(', DFA_DISABLED_DO_OPEN);
+  fn_restart(DFA_DISABLED_DO_OPEN, DFA_DISABLED);
+  fn_set(DFA_DISABLED_DO_OPEN, ')', DFA_START);
+#endif // PART_TWO
+
+  return table;
+}
+
+static constexpr DfaTable DFA_TABLE = dfaBuildTable();
+
+long parseDfa(std::string_view sv)
+{
+  long answer = 0, val1 = 0, val2 = 0;
+  DfaState state = DFA_START;
+  for (size_t pos = 0; pos < sv.size(); ++pos) {
+    // nothing changes until a token can start
+    if (state == DFA_START) {
+      pos = svFindEither(sv, pos, sv.size(), ch_mul_start, ch_do_start);
+      if (pos == sv.size())
+        break;
+    }
+#ifdef PART_TWO
+    else if (state == DFA_DISABLED) {
+      pos = svFindEither(sv, pos, sv.size(), ch_do_start, ch_do_start);
+      if (pos == sv.size())
+        break;
+    }
 #endif // PART_TWO
+
+    auto [next, action] = DFA_TABLE[state][(unsigned char)sv[pos]];
+    switch (action) {
+      case DFA_NONE:
+        break;
+      case DFA_FIRST_DIGIT:
+        val1 = (state == DFA_FIRST_VALUE ? 0 : val1 * 10) + (sv[pos] - '0');
+        break;
+      case DFA_SECOND_DIGIT:
+        val2 = (state == DFA_SECOND_VALUE ? 0 : val2 * 10) + (sv[pos] - '0');
+        break;
+      case DFA_MULTIPLY:
+        answer += val1 * val2;
+        break;
     }
+    state = next;
   }
 
+  return answer;
+}
+
+long parseSequential(std::string_view sv)
+{
+  auto parser = Parser{};
+  while (parser.pos < sv.size())
+    parserStep(parser, sv, sv.size());
+
+  return parser.answer;
+}
+
+#ifdef PARALLEL
+#ifndef PARALLEL_CHUNKS
+#define PARALLEL_CHUNKS std::thread::hardware_concurrency()
+#endif // !PARALLEL_CHUNKS
+
+#ifndef PARALLEL_THREADS
+#define PARALLEL_THREADS std::thread::hardware_concurrency()
+#endif // !PARALLEL_THREADS
+
+// States the parser can be in between tokens, where chunks are entered
+#ifdef PART_TWO
+static constexpr std::array PARSER_ENTRY_STATES = {START_TOKEN, ENABLE_TOKEN};
+#else // PART_TWO
+static constexpr std::array PARSER_ENTRY_STATES = {START_TOKEN};
+#endif // PART_TWO
+
+// Between tokens no operand is carried, so a chunk can be entered here
+bool parserIsBetweenTokens(const Parser& parser)
+{
+  return parser.state != FIRST_VALUE && parser.state != SECOND_VALUE;
+}
+
+// The true parse meets a speculative one within a few tokens, so only the
+// start of each chunk is recorded; past that the true parse steps on alone
+static constexpr size_t PARSER_CHECKPOINT_LIMIT = 1024;
+
+struct ParserCheckpoint
+{
+  size_t pos;
+  ParserState state;
+  long answer;
+};
+
+struct ParserChunkRun
+{
+  Parser exit;
+  std::vector<ParserCheckpoint> checkpoints; // steps between tokens
+};
+
+ParserChunkRun parserRunChunk(std::string_view sv, size_t begin, size_t end, ParserState entry_state)
+{
+  auto run = ParserChunkRun{Parser{entry_state, begin}, {}};
+  auto& parser = run.exit;
+  while (parser.pos < end) {
+    if (parserIsBetweenTokens(parser) && run.checkpoints.size() < PARSER_CHECKPOINT_LIMIT)
+      run.checkpoints.push_back({parser.pos, parser.state, parser.answer});
+    parserStep(parser, sv, end);
+  }
+
+  return run;
+}
+
+// Chunks are claimed in turn by thread_count threads, so the chunk count is
+// not limited by how many threads can be started
+long parseParallel(std::string_view sv, size_t chunk_count, unsigned thread_count)
+{
+  chunk_count = std::clamp<size_t>(chunk_count, 1, std::max<size_t>(1, sv.size()));
+  thread_count = (unsigned)std::clamp<size_t>(thread_count, 1, chunk_count);
+  auto fn_chunk_begin = [sv, chunk_count](size_t idx_chunk) {
+    return sv.size() * idx_chunk / chunk_count;
+  };
+
+  // runs[idx_chunk][idx_entry_state]
+  auto runs = std::vector<std::array<ParserChunkRun, PARSER_ENTRY_STATES.size()>>(chunk_count);
+  auto next_chunk = std::atomic<size_t>{0};
+  auto threads = std::vector<std::thread>{};
+  for (unsigned idx_thread = 0; idx_thread < thread_count; ++idx_thread) {
+    threads.emplace_back([&]() {
+      for (size_t idx_chunk = next_chunk++; idx_chunk < chunk_count; idx_chunk = next_chunk++) {
+        for (size_t idx_state = 0; idx_state < PARSER_ENTRY_STATES.size(); ++idx_state) {
+          runs[idx_chunk][idx_state] = parserRunChunk(sv, fn_chunk_begin(idx_chunk),
+              fn_chunk_begin(idx_chunk + 1), PARSER_ENTRY_STATES[idx_state]);
+        }
+      }
+    });
+  }
+
+  for (auto& thread: threads)
+    thread.join();
+
+  auto parser = Parser{};
+  for (size_t idx_chunk = 0; idx_chunk < chunk_count; ++idx_chunk) {
+    size_t end = fn_chunk_begin(idx_chunk + 1);
+    auto idx_checkpoints = std::array<size_t, PARSER_ENTRY_STATES.size()>{};
+
+    while (parser.pos < end) {
+      bool is_synced = false;
+      for (size_t idx_state = 0; idx_state < PARSER_ENTRY_STATES.size() && !is_synced; ++idx_state) {
+        const auto& run = runs[idx_chunk][idx_state];
+        size_t& idx_checkpoint = idx_checkpoints[idx_state];
+        while (idx_checkpoint < run.checkpoints.size() && run.checkpoints[idx_checkpoint].pos < parser.pos)
+          ++idx_checkpoint;
+
+        if (idx_checkpoint == run.checkpoints.size() || !parserIsBetweenTokens(parser))
+          continue;
+
+        const auto& checkpoint = run.checkpoints[idx_checkpoint];
+        if (checkpoint.pos != parser.pos || checkpoint.state != parser.state)
+          continue;
+
+        // from here the speculative parse and the true parse are the same
+        long answer = parser.answer + run.exit.answer - checkpoint.answer;
+        parser = run.exit;
+        parser.answer = answer;
+        is_synced = true;
+      }
+
+      if (!is_synced)
+        parserStep(parser, sv, end);
+    }
+  }
+
+  return parser.answer;
+}
+
+#ifndef USE_INPUT_FILE
+static constexpr size_t TEST_NOISE_SIZE = 32 << 20;
+static constexpr size_t TEST_NOISE_CHUNKS = 1024;
+
+// Input without a single token start is skipped chunk by chunk, so cutting it
+// into many chunks must not cost much more than parsing it in one
+bool testParseParallelNoiseScales()
+{
+  using Clock = std::chrono::steady_clock;
+  auto str_noise = std::string(TEST_NOISE_SIZE, 'x');
+  auto fn_millis = [&str_noise](size_t chunk_count, long& answer) {
+    auto time_start = Clock::now();
+    answer = parseParallel(str_noise, chunk_count, 1);
+    return std::chrono::duration<double, std::milli>(Clock::now() - time_start).count();
+  };
+
+  long answer_one = -1, answer_many = -1;
+  double millis_one = fn_millis(1, answer_one);
+  double millis_many = fn_millis(TEST_NOISE_CHUNKS, answer_many);
+  return answer_one == 0 && answer_many == 0 && millis_many < 4 * millis_one + 10;
+}
+#endif // !USE_INPUT_FILE
+#endif // PARALLEL
+
+#ifdef BENCHMARK
+static constexpr size_t BENCHMARK_INPUT_SIZE = 64 << 20;
+
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  // mostly noise, with whole and broken tokens mixed in
+  static constexpr std::array fragments = {
+    "mul(12,345)"sv, "mul(7,8)"sv, "mul(1234,5)"sv, "mul[3,7]"sv, "mul(2,"sv,
+    "do()"sv, "don't()"sv, "undo"sv, "mmul(3,3)"sv,
+  };
+  auto rng_engine = std::mt19937{3};
+  auto str_input = std::string{};
+  str_input.reserve(BENCHMARK_INPUT_SIZE);
+  while (str_input.size() < BENCHMARK_INPUT_SIZE) {
+    if (rng_engine() % 64 == 0)
+      str_input += fragments[rng_engine() % fragments.size()];
+    else
+      str_input.push_back((char)(' ' + rng_engine() % 95));
+  }
+
+  double megabytes = str_input.size() / 1e6;
+  std::cout << megabytes << " MB of generated input\n";
+
+  auto time_start = Clock::now();
+  long answer = parseSequential(str_input);
+  double millis = fn_millis(Clock::now() - time_start);
+  std::cout << "  switch: " << millis << " ms (" << megabytes * 1000 / millis << " MB/s, " << answer << ")\n";
+
+  time_start = Clock::now();
+  answer = parseDfa(str_input);
+  millis = fn_millis(Clock::now() - time_start);
+  std::cout << "  DFA:    " << millis << " ms (" << megabytes * 1000 / millis << " MB/s, " << answer << ")\n";
+}
+#endif // BENCHMARK
+
+int main()
+{
+#ifdef BENCHMARK
+  progRunBenchmark();
+  return 0;
+#endif // BENCHMARK
+
+#ifdef USE_INPUT_FILE
+  auto mapped_input = MappedFile(INPUT_FILE);
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+  }
+
+  auto str_input = mapped_input.contents();
+
+#else // USE_INPUT_FILE
+  auto str_input = std::string_view(TEST_INPUT);
+#endif // USE_INPUT_FILE
+
+#ifdef PARALLEL
+  size_t chunk_count = PARALLEL_CHUNKS;
+  auto time_start = std::chrono::steady_clock::now();
+  long answer = parseParallel(str_input, chunk_count, PARALLEL_THREADS);
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+  std::cout << "Parsed " << str_input.size() << " bytes in " << chunk_count << " chunks in "
+    << seconds * 1000 << " ms (" << (seconds > 0 ? str_input.size() / seconds / 1e6 : 0) << " MB/s)\n";
+
+#else // PARALLEL
+  long answer = parseDfa(str_input);
+#endif // PARALLEL
+
   std::cout << "Answer: " << answer << "\n";
 
 #ifndef USE_INPUT_FILE
@@ -175,6 +603,12 @@ int main()
       ? "Test succeeded\n"
       : "Test failed\n"
       );
+
+#ifdef PARALLEL
+  std::cout << (testParseParallelNoiseScales()
+      ? "Chunk scaling test succeeded\n"
+      : "Chunk scaling test failed\n"
+      );
+#endif // PARALLEL
 #endif // !USE_INPUT_FILE
 }
-
@@ -10,7 +10,7 @@
  * 4. Count the number of successful searches
  *
  * Observations:
- * - The input grid is a square
+ * - The input grid is a square, but any rectangle of equal-length lines works
  *
  * ## Part 2
  *
@@ -25,6 +25,27 @@
  * - The orientation of the X is unimportant, it just needs to read `MAS` on both
  *   diagonals, forwards or backwards
  *
+ * The grid is stored in one buffer with a border of three empty cells, as far
+ * as any search reaches, and each of `X`, `M`, `A` and `S` gets a bitboard of
+ * its positions over that buffer. Both parts then test 64 positions at once:
+ * the bitboard rows of the letters each step away are shifted into line with
+ * the first letter, ANDed together, and the matches counted with popcount.
+ *
+ * Compiling with BENCHMARK defined instead times loading the grid, building
+ * the bitboards and both parts on generated square grids from 1000 to 20000
+ * letters across, including the band scan below on one and on every core.
+ *
+ * Compiling with PARALLEL defined splits the grid into bands of lines that
+ * PARALLEL_THREADS threads (one per core by default) take in turn. Each band
+ * builds bitboards for its own lines plus the three lines either side that a
+ * search can reach, counts its matches, and the band counts are summed.
+ *
+ * Compiling with MULTI_PATTERN defined also searches for a whole word list at
+ * once, read one word per line from WORD_LIST_FILE (passed with -D) or just
+ * `XMAS` without it. The words and their reverses are built into an
+ * Aho-Corasick automaton, every row, column, diagonal and anti-diagonal is
+ * streamed through it once, and the count of each word is printed.
+ *
  * ## Answer
  *
  * <details>
@@ -35,18 +56,36 @@
  * </details>
  */
 
+#define STR(x) #x
+#define STR_LIT(x) STR(x)
+
 #include "share.h"
 
-#include <fstream>
+#include <spanstream>
 #include <iostream>
 #include <utility>
 #include <ranges>
 #include <vector>
-#include <sstream>
+#include <array>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#if defined(PARALLEL) || defined(BENCHMARK)
+#include <atomic>
+#include <numeric>
+#include <thread>
+#endif // PARALLEL || BENCHMARK
+
+#ifdef BENCHMARK
+#include <chrono>
+#include <random>
+#endif // BENCHMARK
 
 #ifdef USE_INPUT_FILE
 static constexpr const char * INPUT_FILE = "4.txt";
-static constexpr const size_t INPUT_LENGTH = 140;
 
 #else // USE_INPUT_FILE
 static constexpr const char * TEST_INPUT = R"(MMMSXXMASM
@@ -60,8 +99,6 @@ SAXAMASAAA
 MAMMMXMMMM
 MXMXAXMASX)";
 
-static constexpr const size_t INPUT_LENGTH = 10;
-
 #ifndef PART_TWO
 static constexpr const long TEST_ANSWER = 18;
 #else // !PART_TWO
@@ -69,192 +106,469 @@ static constexpr const long TEST_ANSWER = 9;
 #endif // !PART_TWO
 #endif // USE_INPUT_FILE
 
-enum Direction {
-#ifndef PART_TWO
-  NORTH = 0, NORTH_EAST, EAST, SOUTH_EAST, SOUTH, SOUTH_WEST, WEST, NORTH_WEST
-#else // !PART_TWO
-  NORTH = 0, EAST, SOUTH, WEST,
-  NORTH_EAST, SOUTH_EAST, SOUTH_WEST, NORTH_WEST
-#endif // !PART_TWO
-};
-
 static constexpr const char EMPTY_CHAR = '\0';
 
-struct WordsearchCoords
+// furthest a search reaches from its first letter
+static constexpr size_t GRID_BORDER = 3;
+
+// Row-major cells with a border of EMPTY_CHAR on every side
+struct PaddedGrid
 {
-  size_t line, col;
-  char ch = EMPTY_CHAR; // EMPTY_CHAR is error
+  size_t width, height;
+  size_t stride; // width plus both borders
+  std::vector<char> cells;
 };
 
-using Wordsearch = std::vector<std::string, std::allocator<std::string>>;
-
-WordsearchCoords wordsearchCoordsNextInDirection(WordsearchCoords wc, Direction d, const Wordsearch& wordsearch)
+// Reads lines of equal length into a grid sized to fit them, a final newline
+// is optional. Returns nothing if any line differs in length from the first
+std::optional<PaddedGrid> paddedGridParse(std::string_view sv)
 {
-  WordsearchCoords next_coords{wc.line, wc.col, EMPTY_CHAR};
-  switch (d) {
-    case NORTH:
-      if (wc.line != 0) {
-        --(next_coords.line);
-        next_coords.ch = wordsearch.at(wc.line - 1)[wc.col];
-      }
-      break;
-    case NORTH_EAST:
-      if (wc.line != 0 && wc.col != INPUT_LENGTH - 1) {
-        --(next_coords.line);
-        ++(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line - 1)[wc.col + 1];
-      }
-      break;
-    case EAST:
-      if (wc.col != INPUT_LENGTH - 1) {
-        ++(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line)[wc.col + 1];
-      }
-      break;
-    case SOUTH_EAST:
-      if (wc.line != INPUT_LENGTH - 1 && wc.col != INPUT_LENGTH - 1) {
-        ++(next_coords.line);
-        ++(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line + 1)[wc.col + 1];
-      }
-      break;
-    case SOUTH:
-      if (wc.line != INPUT_LENGTH -1) {
-        ++(next_coords.line);
-        next_coords.ch = wordsearch.at(wc.line + 1)[wc.col];
-      }
-      break;
-    case SOUTH_WEST:
-      if (wc.line != INPUT_LENGTH - 1 && wc.col != 0) {
-        ++(next_coords.line);
-        --(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line + 1)[wc.col - 1];
-      }
-      break;
-    case WEST:
-      if (wc.col != 0) {
-        --(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line)[wc.col - 1];
-      }
+  if (!sv.empty() && sv.back() == '\n')
+    sv.remove_suffix(1);
+
+  size_t width = std::min(sv.find('\n'), sv.size());
+  size_t height = sv.empty() ? 0 : (sv.size() + 1) / (width + 1);
+  size_t stride = width + 2 * GRID_BORDER;
+  auto grid = PaddedGrid{width, height, stride, std::vector<char>((height + 2 * GRID_BORDER) * stride, EMPTY_CHAR)};
+
+  // every line but the last is followed by a newline, so any line of another
+  // length either fails the check below or leaves text after the last line
+  size_t pos = 0;
+  for (size_t idx_line = 0; idx_line <= height; ++idx_line) {
+    if (idx_line == height && (sv.empty() || pos > sv.size()))
       break;
-    case NORTH_WEST:
-      if (wc.line != 0 && wc.col != 0) {
-        --(next_coords.line);
-        --(next_coords.col);
-        next_coords.ch = wordsearch.at(wc.line - 1)[wc.col - 1];
+
+    size_t end = std::min(sv.find('\n', pos), sv.size());
+    if (end - pos != width || idx_line == height) {
+      std::cout << "Line " << idx_line + 1 << " has " << end - pos
+        << " characters, expected " << width << "\n";
+      return std::nullopt;
+    }
+
+    std::ranges::copy(sv.substr(pos, width), std::begin(grid.cells) + (idx_line + GRID_BORDER) * stride + GRID_BORDER);
+    pos = end + 1;
+  }
+
+  return grid;
+}
+
+enum Letter { LETTER_X = 0, LETTER_M, LETTER_A, LETTER_S, LETTER_COUNT };
+
+// Bit (col + 64) of a row is the padded column col, leaving a zero word on
+// both ends so that shifting a word can always borrow from its neighbours
+struct LetterBitboards
+{
+  size_t rows, words_per_row;
+  std::array<std::vector<uint64_t>, LETTER_COUNT> boards;
+};
+
+// Bitboards of grid lines [line_first, line_last) and the GRID_BORDER rows
+// either side of them, so the band can be searched on its own
+LetterBitboards letterBitboardsFromGrid(const PaddedGrid& grid, size_t line_first, size_t line_last)
+{
+  size_t rows = line_last - line_first + 2 * GRID_BORDER;
+  size_t words_per_row = (grid.stride + 63) / 64 + 2;
+  auto bitboards = LetterBitboards{rows, words_per_row, {}};
+  for (auto& board: bitboards.boards)
+    board.assign(rows * words_per_row, 0);
+
+  // one word of each board at a time, without branching on the letters
+  for (size_t row = 0; row < rows; ++row) {
+    const char *cells = grid.cells.data() + (line_first + row) * grid.stride;
+    for (size_t col_first = 0; col_first < grid.stride; col_first += 64) {
+      uint64_t bits_x = 0, bits_m = 0, bits_a = 0, bits_s = 0;
+      for (size_t col = col_first; col < std::min(col_first + 64, grid.stride); ++col) {
+        char ch = cells[col];
+        bits_x |= static_cast<uint64_t>(ch == 'X') << (col - col_first);
+        bits_m |= static_cast<uint64_t>(ch == 'M') << (col - col_first);
+        bits_a |= static_cast<uint64_t>(ch == 'A') << (col - col_first);
+        bits_s |= static_cast<uint64_t>(ch == 'S') << (col - col_first);
       }
-      break;
+
+      size_t idx_word = row * words_per_row + 1 + col_first / 64;
+      bitboards.boards[LETTER_X][idx_word] = bits_x;
+      bitboards.boards[LETTER_M][idx_word] = bits_m;
+      bitboards.boards[LETTER_A][idx_word] = bits_a;
+      bitboards.boards[LETTER_S][idx_word] = bits_s;
+    }
   }
 
-  return next_coords;
+  return bitboards;
 }
 
-Direction directionOpposite(Direction direction)
+LetterBitboards letterBitboardsFromGrid(const PaddedGrid& grid)
 {
-  Direction opposite;
-  switch (direction) {
-    case NORTH:
-      opposite = SOUTH;
-      break;
-    case NORTH_EAST:
-      opposite = SOUTH_WEST;
-      break;
-    case EAST:
-      opposite = WEST;
-      break;
-    case SOUTH_EAST:
-      opposite = NORTH_WEST;
-      break;
-    case SOUTH:
-      opposite = NORTH;
-      break;
-    case SOUTH_WEST:
-      opposite = NORTH_EAST;
-      break;
-    case WEST:
-      opposite = EAST;
-      break;
-    case NORTH_WEST:
-      opposite = SOUTH_EAST;
-      break;
+  return letterBitboardsFromGrid(grid, 0, grid.height);
+}
+
+const uint64_t *letterBitboardsRow(const LetterBitboards& bitboards, Letter letter, size_t row)
+{
+  return bitboards.boards[letter].data() + row * bitboards.words_per_row;
+}
+
+// Word idx_word of a row, shifted so that bit b holds column b + col_offset
+inline uint64_t bitboardWordShifted(const uint64_t *row, size_t idx_word, int col_offset)
+{
+  if (col_offset > 0)
+    return (row[idx_word] >> col_offset) | (row[idx_word + 1] << (64 - col_offset));
+
+  if (col_offset < 0)
+    return (row[idx_word] << -col_offset) | (row[idx_word - 1] >> (64 + col_offset));
+
+  return row[idx_word];
+}
+
+struct Offset
+{
+  int line, col;
+};
+
+static constexpr std::array<Offset, 8> DIRECTION_OFFSETS = {{
+  {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1},
+}};
+
+// Counts XMAS in every direction starting in grid lines [line_first, line_last)
+long letterBitboardsCountXmas(const LetterBitboards& bitboards, size_t line_first, size_t line_last)
+{
+  long count = 0;
+  for (auto [line_step, col_step]: DIRECTION_OFFSETS) {
+    for (size_t row = line_first + GRID_BORDER; row < line_last + GRID_BORDER; ++row) {
+      const uint64_t *row_x = letterBitboardsRow(bitboards, LETTER_X, row);
+      const uint64_t *row_m = letterBitboardsRow(bitboards, LETTER_M, row + line_step);
+      const uint64_t *row_a = letterBitboardsRow(bitboards, LETTER_A, row + 2 * line_step);
+      const uint64_t *row_s = letterBitboardsRow(bitboards, LETTER_S, row + 3 * line_step);
+      for (size_t idx_word = 1; idx_word + 1 < bitboards.words_per_row; ++idx_word) {
+        uint64_t matches = row_x[idx_word]
+          & bitboardWordShifted(row_m, idx_word, col_step)
+          & bitboardWordShifted(row_a, idx_word, 2 * col_step)
+          & bitboardWordShifted(row_s, idx_word, 3 * col_step);
+        count += std::popcount(matches);
+      }
+    }
   }
-  return opposite;
+
+  return count;
 }
 
-int main()
+// Counts A in grid lines [line_first, line_last) with MAS on both diagonals
+long letterBitboardsCountCrossMas(const LetterBitboards& bitboards, size_t line_first, size_t line_last)
 {
-#ifdef USE_INPUT_FILE
-  auto stm_input = std::ifstream(INPUT_FILE);
-  if (!stm_input) {
-    std::cout << "Unable to read input file\n";
+  long count = 0;
+  for (size_t row = line_first + GRID_BORDER; row < line_last + GRID_BORDER; ++row) {
+    const uint64_t *row_a = letterBitboardsRow(bitboards, LETTER_A, row);
+    const uint64_t *row_m_above = letterBitboardsRow(bitboards, LETTER_M, row - 1);
+    const uint64_t *row_s_above = letterBitboardsRow(bitboards, LETTER_S, row - 1);
+    const uint64_t *row_m_below = letterBitboardsRow(bitboards, LETTER_M, row + 1);
+    const uint64_t *row_s_below = letterBitboardsRow(bitboards, LETTER_S, row + 1);
+    for (size_t idx_word = 1; idx_word + 1 < bitboards.words_per_row; ++idx_word) {
+      uint64_t falling_diagonal =
+        (bitboardWordShifted(row_m_above, idx_word, -1) & bitboardWordShifted(row_s_below, idx_word, 1)) |
+        (bitboardWordShifted(row_s_above, idx_word, -1) & bitboardWordShifted(row_m_below, idx_word, 1));
+      uint64_t rising_diagonal =
+        (bitboardWordShifted(row_m_above, idx_word, 1) & bitboardWordShifted(row_s_below, idx_word, -1)) |
+        (bitboardWordShifted(row_s_above, idx_word, 1) & bitboardWordShifted(row_m_below, idx_word, -1));
+      count += std::popcount(row_a[idx_word] & falling_diagonal & rising_diagonal);
+    }
   }
 
-#else // USE_INPUT_FILE
-  auto str_input_storage = std::string(TEST_INPUT);
-  auto stm_input = std::istringstream(str_input_storage);
-#endif // USE_INPUT_FILE
+  return count;
+}
+
+#if defined(PARALLEL) || defined(BENCHMARK)
+#ifndef PARALLEL_THREADS
+#define PARALLEL_THREADS std::thread::hardware_concurrency()
+#endif // !PARALLEL_THREADS
+
+// lines per band, enough that the halo rows are a small share of the work
+static constexpr size_t BAND_LINES = 256;
+
+// Counts with fn_count over bands of BAND_LINES lines, which the threads take
+// in turn. Each band builds its own bitboards with a halo of GRID_BORDER rows
+// either side, so no thread waits on a whole-grid pass
+long paddedGridCountBands(const PaddedGrid& grid, unsigned thread_count, auto fn_count)
+{
+  size_t band_count = (grid.height + BAND_LINES - 1) / BAND_LINES;
+  thread_count = (unsigned)std::clamp<size_t>(thread_count, 1, std::max<size_t>(1, band_count));
 
-  auto wordsearch = Wordsearch{};
-  for (size_t idx_line = 0; idx_line < INPUT_LENGTH; ++idx_line) {
-    std::string& str_line = wordsearch.emplace_back();
-    stmNext(stm_input, &str_line);
+  auto next_band = std::atomic<size_t>{0};
+  auto thread_totals = std::vector<long>(thread_count, 0);
+  auto threads = std::vector<std::thread>{};
+  for (unsigned idx_thread = 0; idx_thread < thread_count; ++idx_thread) {
+    threads.emplace_back([&, idx_thread]() {
+      long total = 0;
+      for (size_t idx_band = next_band++; idx_band < band_count; idx_band = next_band++) {
+        size_t line_first = idx_band * BAND_LINES;
+        size_t line_last = std::min(line_first + BAND_LINES, grid.height);
+        auto bitboards = letterBitboardsFromGrid(grid, line_first, line_last);
+        total += fn_count(bitboards, 0, line_last - line_first);
+      }
+      thread_totals[idx_thread] = total;
+    });
   }
 
-  namespace view = std::views;
+  for (auto& thread: threads)
+    thread.join();
 
-#ifndef PART_TWO
-  auto x_coords = std::vector<WordsearchCoords>{};
-  for (const auto& [idx_line, str_line]: view::enumerate(wordsearch)) {
-    for (const auto& [idx_col, ch]: view::enumerate(str_line)) {
-      if (ch == 'X') x_coords.emplace_back(idx_line, idx_col, ch);
+  return std::accumulate(std::begin(thread_totals), std::end(thread_totals), 0l);
+}
+#endif // PARALLEL || BENCHMARK
+
+#ifdef MULTI_PATTERN
+static constexpr int ALPHABET_SIZE = 26;
+
+// Aho-Corasick automaton over uppercase words, with the failure links folded
+// into a complete transition table so each character is a single lookup
+struct WordAutomaton
+{
+  std::vector<std::array<int32_t, ALPHABET_SIZE>> transitions;
+  std::vector<int32_t> fail;
+  std::vector<int32_t> order; // states in breadth-first order
+  std::vector<int32_t> word_states; // end state of each word, then of its reverse
+};
+
+inline int letterIndex(char ch)
+{
+  return ch >= 'A' && ch <= 'Z' ? ch - 'A' : -1;
+}
+
+int32_t wordAutomatonInsert(WordAutomaton& automaton, auto first, auto last)
+{
+  int32_t state = 0;
+  for (; first != last; ++first) {
+    int letter = letterIndex(*first);
+    if (letter < 0)
+      return -1;
+
+    if (automaton.transitions[state][letter] == 0) {
+      automaton.transitions[state][letter] = static_cast<int32_t>(automaton.transitions.size());
+      automaton.transitions.emplace_back();
     }
+    state = automaton.transitions[state][letter];
   }
 
-  long answer = 0;
-  for (const auto& coords: x_coords) {
-    for (int direction = NORTH; direction <= NORTH_WEST; ++direction) {
-      auto next_coord =  wordsearchCoordsNextInDirection(coords, (Direction)direction, wordsearch);
-      if (next_coord.ch != 'M')
-        continue;
+  return state;
+}
 
-      next_coord = wordsearchCoordsNextInDirection(next_coord, (Direction)direction, wordsearch);
-      if (next_coord.ch != 'A')
-        continue;
+// Words containing anything other than uppercase letters never match
+WordAutomaton wordAutomatonBuild(const std::vector<std::string>& words)
+{
+  auto automaton = WordAutomaton{};
+  automaton.transitions.emplace_back();
+  automaton.word_states.resize(2 * words.size());
+  for (size_t idx_word = 0; idx_word < words.size(); ++idx_word) {
+    const auto& word = words[idx_word];
+    automaton.word_states[2 * idx_word] = wordAutomatonInsert(automaton, std::begin(word), std::end(word));
+    automaton.word_states[2 * idx_word + 1] = wordAutomatonInsert(automaton, std::rbegin(word), std::rend(word));
+  }
 
-      next_coord = wordsearchCoordsNextInDirection(next_coord, (Direction)direction, wordsearch);
-      if (next_coord.ch == 'S')
-        ++answer;
+  automaton.fail.assign(automaton.transitions.size(), 0);
+  automaton.order.reserve(automaton.transitions.size());
+  automaton.order.push_back(0);
+  for (size_t idx_order = 0; idx_order < automaton.order.size(); ++idx_order) {
+    int32_t state = automaton.order[idx_order];
+    for (int letter = 0; letter < ALPHABET_SIZE; ++letter) {
+      int32_t& next = automaton.transitions[state][letter];
+      int32_t fallback = state == 0 ? 0 : automaton.transitions[automaton.fail[state]][letter];
+      if (next == 0) {
+        next = fallback;
+      } else {
+        automaton.fail[next] = fallback;
+        automaton.order.push_back(next);
+      }
     }
   }
 
-#else // !PART_TWO
-  auto a_coords = std::vector<WordsearchCoords>{};
-  for (const auto& [idx_line, str_line]: view::enumerate(wordsearch)) {
-    for (const auto& [idx_col, ch]: view::enumerate(str_line)) {
-      if (ch == 'A') a_coords.emplace_back(idx_line, idx_col, ch);
+  return automaton;
+}
+
+// Feeds count cells starting at cell index first, each step cells apart
+inline void wordAutomatonFeed(const WordAutomaton& automaton, const PaddedGrid& grid,
+    size_t first, ptrdiff_t step, size_t count, std::vector<long>& state_hits)
+{
+  int32_t state = 0;
+  for (size_t idx_cell = first; count > 0; idx_cell += step, --count) {
+    int letter = letterIndex(grid.cells[idx_cell]);
+    state = letter < 0 ? 0 : automaton.transitions[state][letter];
+    ++state_hits[state];
+  }
+}
+
+// Counts each word in all 8 directions, in time linear in the grid size
+std::vector<long> wordAutomatonCountGrid(const WordAutomaton& automaton, const PaddedGrid& grid)
+{
+  auto state_hits = std::vector<long>(automaton.transitions.size(), 0);
+  auto cell = [&grid](size_t line, size_t col) {
+    return (line + GRID_BORDER) * grid.stride + col + GRID_BORDER;
+  };
+  ptrdiff_t stride = static_cast<ptrdiff_t>(grid.stride);
+
+  for (size_t line = 0; line < grid.height; ++line)
+    wordAutomatonFeed(automaton, grid, cell(line, 0), 1, grid.width, state_hits);
+
+  for (size_t col = 0; col < grid.width; ++col)
+    wordAutomatonFeed(automaton, grid, cell(0, col), stride, grid.height, state_hits);
+
+  // diagonals start on the top line, then down the left or right column
+  for (size_t col = 0; col < grid.width; ++col) {
+    wordAutomatonFeed(automaton, grid, cell(0, col), stride + 1,
+        std::min(grid.height, grid.width - col), state_hits);
+    wordAutomatonFeed(automaton, grid, cell(0, col), stride - 1,
+        std::min(grid.height, col + 1), state_hits);
+  }
+  for (size_t line = 1; line < grid.height && grid.width > 0; ++line) {
+    wordAutomatonFeed(automaton, grid, cell(line, 0), stride + 1,
+        std::min(grid.height - line, grid.width), state_hits);
+    wordAutomatonFeed(automaton, grid, cell(line, grid.width - 1), stride - 1,
+        std::min(grid.height - line, grid.width), state_hits);
+  }
+
+  // every state also ends the words ending at its failure state
+  for (auto state: automaton.order | std::views::reverse) {
+    if (state != 0)
+      state_hits[automaton.fail[state]] += state_hits[state];
+  }
+
+  auto counts = std::vector<long>(automaton.word_states.size() / 2, 0);
+  for (size_t idx_word = 0; idx_word < counts.size(); ++idx_word) {
+    for (int32_t state: {automaton.word_states[2 * idx_word], automaton.word_states[2 * idx_word + 1]}) {
+      if (state > 0)
+        counts[idx_word] += state_hits[state];
     }
   }
 
-  long answer = 0;
-  for (const auto& coords: a_coords) {
-    int mas_count = 0; // number of MAS occurences
-    for (int diagonal = NORTH_EAST; diagonal <= NORTH_WEST; ++diagonal) {
-      auto next_coord = wordsearchCoordsNextInDirection(coords, (Direction)diagonal, wordsearch);
-      if (next_coord.ch != 'M')
-        continue;
-
-      next_coord = wordsearchCoordsNextInDirection(coords, directionOpposite((Direction)diagonal), wordsearch);
-      if (next_coord.ch == 'S')
-        ++mas_count;
+  return counts;
+}
+
+// Reads one word per line from WORD_LIST_FILE, or just XMAS without it
+std::vector<std::string> readWordList()
+{
+#ifdef WORD_LIST_FILE
+  auto words = std::vector<std::string>{};
+  auto mapped_words = MappedFile(STR_LIT(WORD_LIST_FILE));
+  if (!mapped_words.isOpen()) {
+    std::cout << "Unable to read word list file\n";
+    return words;
+  }
+
+  auto stm_words = std::ispanstream(mapped_words.contents());
+  auto str_word = std::string{};
+  while (stmNext(stm_words, &str_word) || !str_word.empty()) {
+    if (!str_word.empty())
+      words.push_back(str_word);
+  }
+
+  return words;
+
+#else // WORD_LIST_FILE
+  return {"XMAS"};
+#endif // WORD_LIST_FILE
+}
+#endif // MULTI_PATTERN
+
+#ifdef BENCHMARK
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  auto rng_engine = std::mt19937_64{4};
+  for (size_t side: {1000ul, 5000ul, 10000ul, 20000ul}) {
+    // square grid of random X, M, A and S, two bits per letter
+    auto str_input = std::string((side + 1) * side, '\n');
+    for (size_t idx_line = 0; idx_line < side; ++idx_line) {
+      char *line = str_input.data() + idx_line * (side + 1);
+      for (size_t col = 0; col < side; col += 32) {
+        uint64_t bits = rng_engine();
+        for (size_t idx = col; idx < std::min(col + 32, side); ++idx, bits >>= 2)
+          line[idx] = "XMAS"[bits & 3];
+      }
+    }
+
+    std::cout << side << "x" << side << " grid\n";
+
+    auto time_start = Clock::now();
+    auto grid = paddedGridParse(str_input);
+    std::cout << "  load:      " << fn_millis(Clock::now() - time_start) << " ms\n";
+    str_input = std::string{};
+    if (!grid)
+      continue;
+
+    time_start = Clock::now();
+    auto bitboards = letterBitboardsFromGrid(*grid);
+    std::cout << "  bitboards: " << fn_millis(Clock::now() - time_start) << " ms\n";
+
+    time_start = Clock::now();
+    long count = letterBitboardsCountXmas(bitboards, 0, grid->height);
+    std::cout << "  part 1:    " << fn_millis(Clock::now() - time_start) << " ms (" << count << ")\n";
+
+    time_start = Clock::now();
+    count = letterBitboardsCountCrossMas(bitboards, 0, grid->height);
+    std::cout << "  part 2:    " << fn_millis(Clock::now() - time_start) << " ms (" << count << ")\n";
+    bitboards = LetterBitboards{};
+
+    // bands build their own bitboards, so these include that work
+    for (unsigned thread_count: {1u, std::max(2u, std::thread::hardware_concurrency())}) {
+      time_start = Clock::now();
+      count = paddedGridCountBands(*grid, thread_count, letterBitboardsCountXmas);
+      std::cout << "  part 1, " << thread_count << " band threads: "
+        << fn_millis(Clock::now() - time_start) << " ms (" << count << ")\n";
+
+      time_start = Clock::now();
+      count = paddedGridCountBands(*grid, thread_count, letterBitboardsCountCrossMas);
+      std::cout << "  part 2, " << thread_count << " band threads: "
+        << fn_millis(Clock::now() - time_start) << " ms (" << count << ")\n";
     }
+  }
+}
+#endif // BENCHMARK
+
+int main()
+{
+#ifdef BENCHMARK
+  progRunBenchmark();
+  return 0;
+#endif // BENCHMARK
 
-    if (mas_count == 2)
-      ++answer;
+#ifdef USE_INPUT_FILE
+  auto mapped_input = MappedFile(INPUT_FILE);
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+    return 1;
   }
+  auto opt_grid = paddedGridParse(mapped_input.contents());
+
+#else // USE_INPUT_FILE
+  auto opt_grid = paddedGridParse(TEST_INPUT);
+#endif // USE_INPUT_FILE
+
+  if (!opt_grid)
+    return 1;
+
+  auto& grid = *opt_grid;
+#ifndef PART_TWO
+  auto fn_count = letterBitboardsCountXmas;
+#else // !PART_TWO
+  auto fn_count = letterBitboardsCountCrossMas;
 #endif // !PART_TWO
 
+#ifdef PARALLEL
+  long answer = paddedGridCountBands(grid, PARALLEL_THREADS, fn_count);
+#else // PARALLEL
+  long answer = fn_count(letterBitboardsFromGrid(grid), 0, grid.height);
+#endif // PARALLEL
+
   std::cout << "Answer: " << answer << "\n";
 
+#ifdef MULTI_PATTERN
+  auto words = readWordList();
+  auto automaton = wordAutomatonBuild(words);
+  auto word_counts = wordAutomatonCountGrid(automaton, grid);
+  for (size_t idx_word = 0; idx_word < words.size(); ++idx_word)
+    std::cout << words[idx_word] << ": " << word_counts[idx_word] << "\n";
+#endif // MULTI_PATTERN
+
 #ifndef USE_INPUT_FILE
   std::cout << (answer == TEST_ANSWER
       ? "Test succeeded\n"
@@ -262,4 +576,3 @@ int main()
       );
 #endif // !USE_INPUT_FILE
 }
-
@@ -5,11 +5,11 @@
  * ## Part 1
  *
  * 1. Parse pages order rules and update lists
- * 2. Parse order rules into a lookup map with ascending and descending order
- *    rules
+ * 2. Parse order rules into a precedence matrix, with a bit for every pair of
+ *    pages that is set when the first page must come before the second
  * 3. For each update list, find the pairs of every page with every following page
- * 4. Lookup these pairs in the lookup map, if any yield a descending order, then
- *    the associated update is invalid
+ * 4. Lookup these pairs in the matrix, if the following page must come before
+ *    the preceding page, then the associated update is invalid
  * 5. Take the sum of the middle value of all valid updates
  *
  * Observations:
@@ -19,10 +19,29 @@
  *
  * 1. Parse page order rules and updates lists as in part 1
  * 2. For each update list, search for a pair of any two pages in order that
- *    yields a descending order in the lookup map
- * 3. Swap the values in the update list
- * 4. Reattempt a search for a desending pair of pages
- * 5. Take the middle value of all modified update lists
+ *    are in the wrong order according to the precedence matrix
+ * 3. Count, for each page of an update in the wrong order, how many of the
+ *    other pages it must come before, then select the page with the middle
+ *    count with `nth_element`
+ * 4. If the counts are not all different, the rules do not give one order for
+ *    the update, so sort its pages topologically instead, failing on a cycle
+ * 5. Take the sum of the middle value of all reordered update lists
+ *
+ * Updates are stored back to back in one list, with the offset of each
+ * update's first page in another. Compiling with PARALLEL defined hands out
+ * batches of updates to PARALLEL_THREADS threads (one per core by default),
+ * which share the matrix and the updates, and sums what each thread found.
+ *
+ * Compiling with RULES_CLOSURE defined also works out which pages every page
+ * reaches through the rules, and times it. If no page reaches itself, an
+ * update where each page reaches the next is ordered, one check per page
+ * instead of one per pair. The input's rules do form a cycle, so for it the
+ * closure is only timed and every pair is still checked.
+ *
+ * Compiling with BENCHMARK defined instead times lookups in the precedence
+ * matrix against the map of ascending and descending pairs it replaced, and
+ * both parts on two million generated updates, sequentially, in parallel,
+ * and checked by closure.
  *
  * ## Answer
  *
@@ -36,7 +55,7 @@
 
 #include "share.h"
 
-#include <fstream>
+#include <spanstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -44,11 +63,29 @@
 #include <utility>
 #include <ranges>
 #include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#if defined(PARALLEL) || defined(BENCHMARK)
+#include <atomic>
+#include <numeric>
+#include <thread>
+#endif // PARALLEL || BENCHMARK
+
+#if defined(RULES_CLOSURE) || defined(BENCHMARK)
+#include <chrono>
+#endif // RULES_CLOSURE || BENCHMARK
+
+#ifdef BENCHMARK
+#include <random>
+#endif // BENCHMARK
 
 #ifdef USE_INPUT_FILE
 static constexpr const char * INPUT_FILE = "5.txt";
-static constexpr const int ORDERS_LENGTH = 1176;
-static constexpr const int UPDATES_LENGTH = 223;
 
 #else // USE_INPUT_FILE
 static constexpr const char * TEST_INPUT = R"(47|53
@@ -80,9 +117,6 @@ static constexpr const char * TEST_INPUT = R"(47|53
 61,13,29
 97,13,75,29,47)";
 
-static constexpr const int ORDERS_LENGTH = 21;
-static constexpr const int UPDATES_LENGTH = 6;
-
 #ifndef PART_TWO
 static constexpr const long TEST_ANSWER = 143;
 #else // !PART_TWO
@@ -94,119 +128,449 @@ enum OrderBy { ASCENDING, DESCENDING };
 
 using PagesPair = std::pair<int, int>;
 
-int main()
+// Bit `after` of row `before` is set when page `before` must come before page
+// `after`, rows are sized from the largest page in the rules
+struct PrecedenceMatrix
 {
-#ifdef USE_INPUT_FILE
-  auto stm_input = std::ifstream(INPUT_FILE);
-  if (!stm_input) {
-    std::cout << "Unable to read input file\n";
+  size_t size; // one more than the largest page
+  size_t words_per_row;
+  std::vector<uint64_t> bits;
+  bool has_opposing_rules; // some pair of pages is ordered both ways
+};
+
+// Pages outside the rules have no order
+inline bool precedenceMatrixBefore(const PrecedenceMatrix& matrix, int before, int after)
+{
+  if ((size_t)before >= matrix.size || (size_t)after >= matrix.size)
+    return false;
+
+  return (matrix.bits[before * matrix.words_per_row + after / 64] >> (after % 64)) & 1;
+}
+
+PrecedenceMatrix precedenceMatrixBuild(const std::vector<PagesPair>& rules)
+{
+  int page_max = 0;
+  for (auto [before, after]: rules)
+    page_max = std::max({page_max, before, after});
+
+  size_t size = page_max + 1;
+  size_t words_per_row = (size + 63) / 64;
+  auto matrix = PrecedenceMatrix{size, words_per_row, std::vector<uint64_t>(size * words_per_row, 0), false};
+  for (auto [before, after]: rules)
+    matrix.bits[before * words_per_row + after / 64] |= 1ull << (after % 64);
+
+  for (auto [before, after]: rules)
+    matrix.has_opposing_rules |= precedenceMatrixBefore(matrix, after, before);
+
+  return matrix;
+}
+
+// Reachability over the rules, Floyd-Warshall a word of 64 pages at a time:
+// every page that reaches page k also reaches everything page k does
+PrecedenceMatrix precedenceMatrixClosure(const PrecedenceMatrix& matrix)
+{
+  auto closure = matrix;
+  for (size_t page_via = 0; page_via < closure.size; ++page_via) {
+    const uint64_t *row_via = closure.bits.data() + page_via * closure.words_per_row;
+    for (size_t page = 0; page < closure.size; ++page) {
+      if (!precedenceMatrixBefore(closure, page, page_via))
+        continue;
+
+      uint64_t *row = closure.bits.data() + page * closure.words_per_row;
+      for (size_t idx_word = 0; idx_word < closure.words_per_row; ++idx_word)
+        row[idx_word] |= row_via[idx_word];
+    }
   }
 
-#else // USE_INPUT_FILE
-  auto str_input_storage = std::string(TEST_INPUT);
-  auto stm_input = std::istringstream(str_input_storage);
-#endif // USE_INPUT_FILE
+  return closure;
+}
 
-  auto graph_pages_pairs = std::map<PagesPair, OrderBy>{};
-  for (int idx = 0; idx < ORDERS_LENGTH; idx++) {
-    char skip_char{};
-    int before, after;
-    stm_input >> before;
-    stm_input.get(skip_char); // skip `|`
-    stm_input >> after;
-    stmNext(stm_input);
-
-    auto ascending_order = PagesPair{before, after};
-    auto descending_order = PagesPair{after, before};
-    graph_pages_pairs[ascending_order] = ASCENDING;
-    graph_pages_pairs[descending_order] = DESCENDING;
-  }
-
-  {
-    char skip_char{};
-    stm_input.get(skip_char); // skip blank line
-  }
-
-  namespace views = std::views;
-  namespace ranges = std::ranges;
-
-  static constexpr const int PAGE_UPDATE_SEPARATOR = 0;
-  auto list_separated_page_updates = std::vector<int>{};
-  for (int idx = 0; idx < UPDATES_LENGTH; idx++) {
-    std::string str_line{}, str_page_number{};
-    stmNext(stm_input, &str_line);
-    for (const auto& vw_pair : str_line | views::split(',')) {
-      str_page_number.clear();
-      ranges::copy(vw_pair, std::begin(str_page_number));
-      list_separated_page_updates.push_back(std::stoi(str_page_number));
+// A closure with no page that must come before itself
+bool precedenceMatrixIsAcyclic(const PrecedenceMatrix& closure)
+{
+  for (size_t page = 0; page < closure.size; ++page) {
+    if (precedenceMatrixBefore(closure, page, page))
+      return false;
+  }
+
+  return true;
+}
+
+using Update = std::span<const int>;
+
+// Update idx is pages[offsets[idx]] up to pages[offsets[idx + 1]]
+struct Updates
+{
+  std::vector<int> pages;
+  std::vector<size_t> offsets{0};
+};
+
+size_t updatesCount(const Updates& updates)
+{
+  return updates.offsets.size() - 1;
+}
+
+Update updatesAt(const Updates& updates, size_t idx)
+{
+  return {updates.pages.data() + updates.offsets[idx], updates.pages.data() + updates.offsets[idx + 1]};
+}
+
+// Adds the comma separated pages of one line as an update, unless it is empty
+void updatesParseLine(Updates& updates, std::string_view sv)
+{
+  const char *it_char = sv.data(), *it_end = sv.data() + sv.size();
+  while (it_char < it_end) {
+    int page = 0;
+    auto [it_next, ec] = std::from_chars(it_char, it_end, page);
+    if (ec == std::errc{})
+      updates.pages.push_back(page);
+    it_char = it_next + 1; // skip `,`
+  }
+
+  if (updates.pages.size() != updates.offsets.back())
+    updates.offsets.push_back(updates.pages.size());
+}
+
+// Every page is checked against all pages after it, not just the next one,
+// as the rules are not transitive
+bool updateIsOrdered(const PrecedenceMatrix& matrix, Update update)
+{
+  for (size_t idx_preceding = 0; idx_preceding < update.size(); ++idx_preceding) {
+    for (size_t idx_following = idx_preceding + 1; idx_following < update.size(); ++idx_following) {
+      if (precedenceMatrixBefore(matrix, update[idx_following], update[idx_preceding]))
+        return false;
     }
+  }
+
+  return true;
+}
 
-    list_separated_page_updates.push_back(PAGE_UPDATE_SEPARATOR);
+// With an acyclic closure, an update where each page reaches the next is
+// ordered: each page then reaches every later page, so no rule can put a later
+// page first. Any other update still needs the full pair walk
+bool updateIsOrderedByClosure(const PrecedenceMatrix& matrix, const PrecedenceMatrix& closure, Update update)
+{
+  for (size_t idx = 1; idx < update.size(); ++idx) {
+    if (!precedenceMatrixBefore(closure, update[idx - 1], update[idx]))
+      return updateIsOrdered(matrix, update);
   }
 
-#ifndef PART_TWO
-  long answer = 0;
-  auto vw_updates = list_separated_page_updates | views::split(PAGE_UPDATE_SEPARATOR);
-  const auto sentinel_not_in_graph = std::end(graph_pages_pairs);
-
-  for (const auto& update : vw_updates) {
-    bool is_update_valid = !ranges::empty(update);
-    for (auto it_preceding_page = std::begin(update); it_preceding_page != std::end(update); ++it_preceding_page) {
-      if (!is_update_valid)
-        break;
-
-      for (const auto& following_page : ranges::subrange(it_preceding_page + 1, std::end(update))) {
-        const auto maybe_page_pair = graph_pages_pairs.find({*it_preceding_page, following_page});
-        if (maybe_page_pair == sentinel_not_in_graph)
-          continue;
-
-        if (maybe_page_pair->second == DESCENDING) {
-          is_update_valid = false;
-          break;
-        }
-      }
+  return true;
+}
+
+// Kahn's algorithm over the rules between the pages of the update, returns
+// nothing if they form a cycle
+std::optional<std::vector<int>> updateSortTopological(const PrecedenceMatrix& matrix, Update update)
+{
+  auto predecessor_counts = std::vector<size_t>(update.size(), 0);
+  for (size_t idx_page = 0; idx_page < update.size(); ++idx_page) {
+    for (int other_page: update)
+      predecessor_counts[idx_page] += precedenceMatrixBefore(matrix, other_page, update[idx_page]);
+  }
+
+  auto ready = std::vector<size_t>{};
+  for (size_t idx_page = 0; idx_page < update.size(); ++idx_page) {
+    if (predecessor_counts[idx_page] == 0)
+      ready.push_back(idx_page);
+  }
+
+  auto sorted_update = std::vector<int>{};
+  while (!ready.empty()) {
+    size_t idx_page = ready.back();
+    ready.pop_back();
+    sorted_update.push_back(update[idx_page]);
+    for (size_t idx_next = 0; idx_next < update.size(); ++idx_next) {
+      if (precedenceMatrixBefore(matrix, update[idx_page], update[idx_next]) && --predecessor_counts[idx_next] == 0)
+        ready.push_back(idx_next);
     }
+  }
+
+  if (sorted_update.size() != update.size())
+    return std::nullopt;
+
+  return sorted_update;
+}
+
+// Middle page of the update once ordered by the rules, or nothing if the rules
+// between its pages form a cycle
+std::optional<int> updateOrderedMiddle(const PrecedenceMatrix& matrix, Update update)
+{
+  // When the rules order every pair of pages in the update, the first page
+  // must come before all k - 1 others, the next before k - 2, down to 0 for
+  // the last, so ranking by those counts finds the middle page without
+  // sorting. The counts are one popcount per word of the page's row. Without
+  // opposing rules, counts that are all different can only come from such an
+  // order, so anything else goes to the topological sort
+  auto update_mask = std::vector<uint64_t>(matrix.words_per_row, 0);
+  for (int page: update) {
+    if ((size_t)page < matrix.size)
+      update_mask[page / 64] |= 1ull << (page % 64);
+  }
 
-    if (is_update_valid) {
-      int middle_value = ranges::cdata(update)[ranges::size(update)/2];
-      answer += middle_value;
+  auto ranked_pages = std::vector<PagesPair>{}; // successor count, page
+  auto seen_counts = std::vector<bool>(update.size(), false);
+  bool is_total_order = !matrix.has_opposing_rules;
+  for (int page: update) {
+    int successor_count = 0;
+    if ((size_t)page < matrix.size) {
+      for (size_t idx_word = 0; idx_word < matrix.words_per_row; ++idx_word)
+        successor_count += std::popcount(matrix.bits[page * matrix.words_per_row + idx_word] & update_mask[idx_word]);
     }
+
+    if ((size_t)successor_count >= update.size() || seen_counts[successor_count])
+      is_total_order = false;
+    else
+      seen_counts[successor_count] = true;
+    ranked_pages.emplace_back(successor_count, page);
   }
 
+  if (is_total_order) {
+    auto it_middle = std::begin(ranked_pages) + ranked_pages.size() / 2;
+    std::ranges::nth_element(ranked_pages, it_middle, std::ranges::greater{});
+    return it_middle->second;
+  }
+
+  auto sorted_update = updateSortTopological(matrix, update);
+  if (!sorted_update)
+    return std::nullopt;
+
+  return (*sorted_update)[sorted_update->size() / 2];
+}
+
+// Sums the middle pages of updates [idx_first, idx_last) that count towards the
+// answer, checking order with the acyclic closure when given one. Stops at the
+// first update whose rules form a cycle, returning its index in idx_cycle,
+// which is otherwise left alone
+long updatesSumMiddles(const PrecedenceMatrix& matrix, const PrecedenceMatrix *closure,
+    const Updates& updates, size_t idx_first, size_t idx_last, [[maybe_unused]] size_t& idx_cycle)
+{
+  long sum = 0;
+  for (size_t idx = idx_first; idx < idx_last; ++idx) {
+    auto update = updatesAt(updates, idx);
+    bool is_ordered = closure
+      ? updateIsOrderedByClosure(matrix, *closure, update)
+      : updateIsOrdered(matrix, update);
+#ifndef PART_TWO
+    if (is_ordered)
+      sum += update[update.size() / 2];
+
 #else // !PART_TWO
-  long answer = 0;
-  auto vw_updates = list_separated_page_updates | views::split(PAGE_UPDATE_SEPARATOR);
-  const auto sentinel_not_in_graph = std::end(graph_pages_pairs);
-
-  for (auto update : vw_updates) {
-    bool is_modified = false;
-    for (auto it_preceding_page = std::begin(update); it_preceding_page != std::end(update); ++it_preceding_page) {
-      if (ranges::empty(update))
-        break;
-
-      for (auto it_following_page = it_preceding_page + 1; it_following_page != std::end(update); ++it_following_page) {
-        const auto maybe_page_pair = graph_pages_pairs.find({*it_preceding_page, *it_following_page});
-        if (maybe_page_pair == sentinel_not_in_graph)
-          continue;
-
-        if (maybe_page_pair->second == DESCENDING) {
-          std::iter_swap(it_preceding_page, it_following_page);
-          is_modified = true;
-          // ideally has a failsafe to prevent infinite loop
-          it_preceding_page = std::begin(update);
-          it_following_page = it_preceding_page + 1;
-          continue;
-        }
-      }
+    if (is_ordered)
+      continue;
+
+    auto middle_value = updateOrderedMiddle(matrix, update);
+    if (!middle_value) {
+      idx_cycle = idx;
+      break;
     }
+    sum += *middle_value;
+#endif // !PART_TWO
+  }
+
+  return sum;
+}
+
+#if defined(PARALLEL) || defined(BENCHMARK)
+#ifndef PARALLEL_THREADS
+#define PARALLEL_THREADS std::thread::hardware_concurrency()
+#endif // !PARALLEL_THREADS
+
+// updates a thread takes at a time, small enough that threads finishing early
+// can take over the rest of the work
+static constexpr size_t UPDATE_BATCH = 1024;
+
+// As updatesSumMiddles over all updates, in batches taken in turn by the
+// threads, which share the read-only matrix and updates. idx_cycle is the
+// first update with a cycle found, not necessarily the first in the input
+long updatesSumMiddlesParallel(const PrecedenceMatrix& matrix, const PrecedenceMatrix *closure,
+    const Updates& updates, unsigned thread_count, size_t& idx_cycle)
+{
+  size_t batch_count = (updatesCount(updates) + UPDATE_BATCH - 1) / UPDATE_BATCH;
+  thread_count = (unsigned)std::clamp<size_t>(thread_count, 1, std::max<size_t>(1, batch_count));
+
+  auto next_batch = std::atomic<size_t>{0};
+  auto thread_sums = std::vector<long>(thread_count, 0);
+  auto thread_cycles = std::vector<size_t>(thread_count, SIZE_MAX);
+  auto threads = std::vector<std::thread>{};
+  for (unsigned idx_thread = 0; idx_thread < thread_count; ++idx_thread) {
+    threads.emplace_back([&, idx_thread]() {
+      long sum = 0;
+      size_t idx_thread_cycle = SIZE_MAX;
+      for (size_t idx_batch = next_batch++; idx_batch < batch_count && idx_thread_cycle == SIZE_MAX; idx_batch = next_batch++) {
+        size_t idx_first = idx_batch * UPDATE_BATCH;
+        size_t idx_last = std::min(idx_first + UPDATE_BATCH, updatesCount(updates));
+        sum += updatesSumMiddles(matrix, closure, updates, idx_first, idx_last, idx_thread_cycle);
+      }
+      thread_sums[idx_thread] = sum;
+      thread_cycles[idx_thread] = idx_thread_cycle;
+    });
+  }
+
+  for (auto& thread: threads)
+    thread.join();
+
+  idx_cycle = std::min(idx_cycle, std::ranges::min(thread_cycles));
+  return std::accumulate(std::begin(thread_sums), std::end(thread_sums), 0l);
+}
+#endif // PARALLEL || BENCHMARK
+
+#ifdef BENCHMARK
+// random page pairs looked up in each rule index
+static constexpr size_t BENCHMARK_LOOKUPS = 10000000;
+
+// generated updates checked sequentially and in parallel
+static constexpr size_t BENCHMARK_UPDATES = 2000000;
+
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  // as many rules as the input, over the same range of pages
+  auto rng_engine = std::mt19937{5};
+  auto dist_page = std::uniform_int_distribution<int>{10, 99};
+  auto rules = std::vector<PagesPair>{};
+  while (rules.size() < 1176) {
+    int before = dist_page(rng_engine), after = dist_page(rng_engine);
+    if (before < after)
+      rules.emplace_back(before, after);
+  }
+
+  auto graph_pages_pairs = std::map<PagesPair, OrderBy>{};
+  for (auto [before, after]: rules) {
+    graph_pages_pairs[{before, after}] = ASCENDING;
+    graph_pages_pairs[{after, before}] = DESCENDING;
+  }
+  auto matrix = precedenceMatrixBuild(rules);
 
-    if (is_modified) {
-      int middle_value = ranges::cdata(update)[ranges::size(update)/2];
-      answer += middle_value;
+  auto lookups = std::vector<PagesPair>(BENCHMARK_LOOKUPS);
+  for (auto& pair: lookups)
+    pair = {dist_page(rng_engine), dist_page(rng_engine)};
+
+  auto time_start = Clock::now();
+  long descending_count = 0;
+  for (const auto& pair: lookups) {
+    auto maybe_page_pair = graph_pages_pairs.find(pair);
+    descending_count += maybe_page_pair != std::end(graph_pages_pairs) && maybe_page_pair->second == DESCENDING;
+  }
+  std::cout << BENCHMARK_LOOKUPS << " lookups\n";
+  std::cout << "  map:    " << fn_millis(Clock::now() - time_start)
+    << " ms (" << descending_count << " descending)\n";
+
+  time_start = Clock::now();
+  descending_count = 0;
+  for (auto [preceding, following]: lookups)
+    descending_count += precedenceMatrixBefore(matrix, following, preceding);
+  std::cout << "  matrix: " << fn_millis(Clock::now() - time_start)
+    << " ms (" << descending_count << " descending)\n";
+
+  // rules between every pair of pages, as in the input, taken from one
+  // shuffled order so there is no cycle, and updates of 5 to 23 pages
+  auto pages = std::vector<int>{};
+  for (int page = 10; page <= 99; ++page)
+    pages.push_back(page);
+  std::ranges::shuffle(pages, rng_engine);
+
+  rules.clear();
+  for (size_t idx_before = 0; idx_before < pages.size(); ++idx_before) {
+    for (size_t idx_after = idx_before + 1; idx_after < pages.size(); ++idx_after)
+      rules.emplace_back(pages[idx_before], pages[idx_after]);
+  }
+  matrix = precedenceMatrixBuild(rules);
+
+  auto updates = Updates{};
+  for (size_t idx_update = 0; idx_update < BENCHMARK_UPDATES; ++idx_update) {
+    size_t length = 5 + 2 * (rng_engine() % 10);
+    for (size_t idx = 0; idx < length; ++idx) {
+      std::swap(pages[idx], pages[idx + rng_engine() % (pages.size() - idx)]);
+      updates.pages.push_back(pages[idx]);
     }
+    updates.offsets.push_back(updates.pages.size());
   }
 
-#endif // !PART_TWO
+  std::cout << updatesCount(updates) << " updates\n";
+
+  size_t idx_cycle = SIZE_MAX;
+  time_start = Clock::now();
+  long sum = updatesSumMiddles(matrix, nullptr, updates, 0, updatesCount(updates), idx_cycle);
+  std::cout << "  sequential:  " << fn_millis(Clock::now() - time_start) << " ms (" << sum << ")\n";
+
+  for (unsigned thread_count: {1u, std::max(2u, std::thread::hardware_concurrency())}) {
+    time_start = Clock::now();
+    sum = updatesSumMiddlesParallel(matrix, nullptr, updates, thread_count, idx_cycle);
+    std::cout << "  " << thread_count << " threads:   " << fn_millis(Clock::now() - time_start) << " ms (" << sum << ")\n";
+  }
+
+  time_start = Clock::now();
+  auto closure = precedenceMatrixClosure(matrix);
+  std::cout << "  closure:     " << fn_millis(Clock::now() - time_start) << " ms\n";
+
+  time_start = Clock::now();
+  sum = updatesSumMiddles(matrix, &closure, updates, 0, updatesCount(updates), idx_cycle);
+  std::cout << "  by closure:  " << fn_millis(Clock::now() - time_start) << " ms (" << sum << ")\n";
+}
+#endif // BENCHMARK
+
+int main()
+{
+#ifdef BENCHMARK
+  progRunBenchmark();
+  return 0;
+#endif // BENCHMARK
+
+#ifdef USE_INPUT_FILE
+  auto mapped_input = MappedFile(INPUT_FILE);
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+  }
+  auto stm_input = std::ispanstream(mapped_input.contents());
+
+#else // USE_INPUT_FILE
+  auto str_input_storage = std::string(TEST_INPUT);
+  auto stm_input = std::istringstream(str_input_storage);
+#endif // USE_INPUT_FILE
+
+  // rules up to the blank line, then one update per line
+  auto rules = std::vector<PagesPair>{};
+  auto str_line = std::string{};
+  while (stmNext(stm_input, &str_line) && !str_line.empty()) {
+    int before = 0, after = 0;
+    auto [it_separator, ec] = std::from_chars(str_line.data(), str_line.data() + str_line.size(), before);
+    std::from_chars(it_separator + 1, str_line.data() + str_line.size(), after); // skip `|`
+    rules.emplace_back(before, after);
+  }
+
+  auto matrix = precedenceMatrixBuild(rules);
+
+  auto updates = Updates{};
+  while (stmNext(stm_input, &str_line) || !str_line.empty())
+    updatesParseLine(updates, str_line);
+
+  const PrecedenceMatrix *closure = nullptr;
+#ifdef RULES_CLOSURE
+  auto time_start = std::chrono::steady_clock::now();
+  auto rules_closure = precedenceMatrixClosure(matrix);
+  auto millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_start).count();
+  std::cout << "Closure of rules for pages up to " << rules_closure.size - 1 << " computed in " << millis << " ms\n";
+  if (precedenceMatrixIsAcyclic(rules_closure))
+    closure = &rules_closure;
+  else
+    std::cout << "Rules form a cycle, checking every pair of pages instead\n";
+#endif // RULES_CLOSURE
+
+  size_t idx_cycle = SIZE_MAX;
+#ifdef PARALLEL
+  long answer = updatesSumMiddlesParallel(matrix, closure, updates, PARALLEL_THREADS, idx_cycle);
+#else // PARALLEL
+  long answer = updatesSumMiddles(matrix, closure, updates, 0, updatesCount(updates), idx_cycle);
+#endif // PARALLEL
+
+  if (idx_cycle != SIZE_MAX) {
+    std::cout << "Rules form a cycle between the pages of update " << idx_cycle + 1 << "\n";
+    return 1;
+  }
 
   std::cout << "Answer: " << answer << "\n";
 
@@ -1,4 +1,4 @@
-/* # Advent of Code: Day 6 (Incomplete)
+/* # Advent of Code: Day 6
  *
  * Input for this program is `6.txt`
  *
@@ -12,15 +12,39 @@
  *    - Otherwise the guard moves in the direction they are facing
  * 3. Find the number of positions within the grid in the guard's path
  *
+ * The guard is not moved one tile at a time. A jump table holds, for every
+ * tile and direction, the tile where the guard would stop in front of an
+ * obstruction, or that they would leave the grid, so each leg of the path is
+ * one lookup.
+ *
+ * Visited tiles are a bitmap, and the directions the guard has turned to at
+ * each tile are 4 bits, so a 130x130 grid needs about 11 KB, which each walk
+ * reuses.
+ *
+ * The grid is sized from the input and surrounded by a border of tiles marked
+ * as outside, so a guard stepping off the grid lands on one of them instead
+ * of needing a bounds check. A guard who walks off the grid stops on the
+ * border in the jump table.
+ *
  * ## Part 2
  *
  * 1. Parse input into a grid of tiles and starting position and orientation of a
  *    guard, as above
- * 2. Travel around the grid using the same rules as above, but for each tile that
- *    the guard travels, check if a theoretical guard, started at the guard's
- *    position, but turned right by 90 degrees would loop
- * 3. Count the number of positions at which the guard could theoretically loop
- *    were an obstale placed in front of them
+ * 2. Find the guard's path as in part 1, as a new obstruction anywhere else
+ *    would never be reached
+ * 3. For each tile of the path except the starting one, add an obstruction
+ *    there and follow the guard from the start, until they leave the grid or
+ *    turn at the same tile in the same direction a second time, which is a loop
+ * 4. Count the number of tiles where the guard loops
+ *
+ * The tiles are shared out between PARALLEL_THREADS threads (one per core by
+ * default), which share the grid and jump table. The one added obstruction is
+ * applied to each lookup instead, cutting short a leg that would pass it.
+ *
+ * Compiling with BENCHMARK defined instead generates random maps from 1000 to
+ * 10000 tiles across, each one thinned out until the guard leaves it, and
+ * times loading, building the jump table, the path, and testing up to 20000
+ * obstructions along it.
  *
  * ## Answer
  *
@@ -28,21 +52,36 @@
  *  <summary>Spoilers</summary>
  *  Part 1: 4433
  *
- *  Part 2:
+ *  Part 2: 1516
  * </details>
  */
 
 #include "share.h"
 
-#include <fstream>
 #include <iostream>
-#include <sstream>
-#include <array>
-#include <set>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include <optional>
+#include <string_view>
+#include <span>
+#include <utility>
+
+#if defined(PART_TWO) || defined(BENCHMARK)
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#endif // PART_TWO || BENCHMARK
+
+#ifdef BENCHMARK
+#include <random>
+#include <unordered_set>
+#endif // BENCHMARK
 
 #ifdef USE_INPUT_FILE
 static constexpr const char * INPUT_FILE = "6.txt";
-static constexpr const int GRID_SIZE = 130;
 
 #else // USE_INPUT_FILE
 static constexpr const char * TEST_INPUT = R"(....#.....
@@ -56,8 +95,6 @@ static constexpr const char * TEST_INPUT = R"(....#.....
 #.........
 ......#...)";
 
-static constexpr const int GRID_SIZE = 10;
-
 #ifndef PART_TWO
 static constexpr const long TEST_ANSWER = 41;
 
@@ -68,7 +105,7 @@ static constexpr const long TEST_ANSWER = 6;
 
 #endif // USE_INPUT_FILE
 
-enum Tile { GROUND = 0, OBSTRUCTION };
+enum Tile : uint8_t { GROUND = 0, OBSTRUCTION, OUTSIDE };
 
 enum Direction { NORTH = 0, EAST, SOUTH, WEST };
 
@@ -92,159 +129,487 @@ Direction directionTurn(Direction d)
   return next_direction;
 }
 
-static constexpr size_t NOT_IN_GRID = GRID_SIZE;
-
 struct Position {
   long x, y;
 
   constexpr auto operator<=>(const Position& other) const = default;
 };
 
-Position positionNextInDirection(Position pos, Direction d)
+struct Guard {
+  Position position;
+  Direction facing;
+};
+
+// Row-major tiles with a border of OUTSIDE one tile wide on every side
+struct Grid
+{
+  long width, height;
+  size_t stride; // width plus both borders
+  std::vector<Tile> tiles;
+};
+
+size_t positionToGridIndex(const Grid& grid, Position pos)
+{
+  return (pos.y + 1) * grid.stride + pos.x + 1;
+}
+
+Position positionFromGridIndex(const Grid& grid, size_t idx)
+{
+  return { (long)(idx % grid.stride) - 1, (long)(idx / grid.stride) - 1 };
+}
+
+// Offset between the indices of neighbouring tiles
+ptrdiff_t gridStep(const Grid& grid, Direction d)
 {
-  Position next_pos{pos};
+  ptrdiff_t step{};
   switch (d) {
     case NORTH:
-      (next_pos.y)--;
+      step = -(ptrdiff_t)grid.stride;
       break;
     case EAST:
-      (next_pos.x)++;
+      step = 1;
       break;
     case SOUTH:
-      (next_pos.y)++;
+      step = grid.stride;
       break;
     case WEST:
-      (next_pos.x)--;
+      step = -1;
       break;
   }
+  return step;
+}
+
+Grid gridBuild(long width, long height)
+{
+  size_t stride = width + 2;
+  auto grid = Grid{width, height, stride, std::vector<Tile>(stride * (height + 2), OUTSIDE)};
+  for (long y = 0; y < height; ++y)
+    std::fill_n(std::begin(grid.tiles) + positionToGridIndex(grid, {0, y}), width, GROUND);
 
-  if (next_pos.x < 0 || next_pos.x >= GRID_SIZE)
-    next_pos.x = NOT_IN_GRID;
+  return grid;
+}
+
+// Reads lines of equal length, with `#` for an obstruction and the guard as
+// one of `^>v<`. Returns nothing if a line differs in length from the first
+// or there is no guard
+std::optional<std::pair<Grid, Guard>> gridParse(std::string_view sv)
+{
+  if (!sv.empty() && sv.back() == '\n')
+    sv.remove_suffix(1);
+
+  long width = std::min(sv.find('\n'), sv.size());
+  long height = sv.empty() ? 0 : (sv.size() + 1) / (width + 1);
+  auto grid = gridBuild(width, height);
+  auto guard = std::optional<Guard>{};
 
-  if (next_pos.y < 0 || next_pos.y >= GRID_SIZE)
-    next_pos.y = NOT_IN_GRID;
+  size_t pos = 0;
+  for (long y = 0; y <= height; ++y) {
+    if (y == height && (sv.empty() || pos > sv.size()))
+      break;
+
+    size_t end = std::min(sv.find('\n', pos), sv.size());
+    if ((long)(end - pos) != width || y == height) {
+      std::cout << "Line " << y + 1 << " has " << end - pos
+        << " characters, expected " << width << "\n";
+      return std::nullopt;
+    }
 
-  return next_pos;
+    for (long x = 0; x < width; ++x) {
+      static constexpr std::string_view GUARD_CHARS = "^>v<";
+      char ch = sv[pos + x];
+      if (ch == '#')
+        grid.tiles[positionToGridIndex(grid, {x, y})] = OBSTRUCTION;
+      else if (size_t facing = GUARD_CHARS.find(ch); facing != std::string_view::npos)
+        guard = Guard{{x, y}, Direction(facing)};
+    }
+    pos = end + 1;
+  }
+
+  if (!guard) {
+    std::cout << "No guard found in the grid\n";
+    return std::nullopt;
+  }
+
+  return std::pair{std::move(grid), *guard};
 }
 
-bool positionIsInGrid(Position pos)
+// Where the guard stops, facing an obstruction, after moving from a tile in a
+// direction, as a grid index, for every tile and direction. A guard who would
+// walk off the grid stops on the border instead
+using JumpTable = std::vector<uint32_t>; // [tile * 4 + direction]
+
+size_t jumpTableIndex(size_t idx_cell, Direction d)
 {
-  return pos.x != NOT_IN_GRID && pos.y != NOT_IN_GRID;
+  return idx_cell * 4 + d;
 }
 
-Position positionFromGridIndex(size_t idx)
+// Each tile stops where the tile after it does, unless that is an obstruction,
+// so lines are scanned from the border back. Columns are scanned a row at a
+// time, all together, so the grid is only ever read along its rows
+void jumpTableBuildRows(JumpTable& table, const Grid& grid, Direction d, long y_first, long y_last, long y_step)
 {
-  return { (long)idx % GRID_SIZE, (long)idx / GRID_SIZE };
+  ptrdiff_t step = gridStep(grid, d);
+  auto column_stops = std::vector<uint32_t>(grid.width);
+  for (long x = 0; x < grid.width; ++x)
+    column_stops[x] = positionToGridIndex(grid, {x, y_first - y_step});
+
+  for (long y = y_first; y != y_last; y += y_step) {
+    size_t idx_row = positionToGridIndex(grid, {0, y});
+    for (long x = 0; x < grid.width; ++x) {
+      if (grid.tiles[idx_row + x] == OBSTRUCTION)
+        column_stops[x] = idx_row + x - step;
+      table[jumpTableIndex(idx_row + x, d)] = column_stops[x];
+    }
+  }
 }
 
-size_t positionToGridIndex(Position pos)
+JumpTable jumpTableBuild(const Grid& grid)
 {
-  return pos.y * GRID_SIZE + pos.x;
+  auto table = JumpTable(grid.tiles.size() * 4, 0);
+  for (long y = 0; y < grid.height; ++y) {
+    size_t idx_row = positionToGridIndex(grid, {0, y});
+    uint32_t idx_stop = idx_row + grid.width;
+    for (long x = grid.width - 1; x >= 0; --x) {
+      if (grid.tiles[idx_row + x] == OBSTRUCTION)
+        idx_stop = idx_row + x - 1;
+      table[jumpTableIndex(idx_row + x, EAST)] = idx_stop;
+    }
+
+    idx_stop = idx_row - 1;
+    for (long x = 0; x < grid.width; ++x) {
+      if (grid.tiles[idx_row + x] == OBSTRUCTION)
+        idx_stop = idx_row + x + 1;
+      table[jumpTableIndex(idx_row + x, WEST)] = idx_stop;
+    }
+  }
+
+  jumpTableBuildRows(table, grid, NORTH, 0, grid.height, 1);
+  jumpTableBuildRows(table, grid, SOUTH, grid.height - 1, -1, -1);
+
+  return table;
 }
 
-struct Guard {
-  Position position;
-  Direction facing;
-#ifdef PART_TWO
-  constexpr auto operator<=>(const Guard& other) const = default;
-#endif // PART_TWO
+static constexpr size_t NO_OBSTRUCTION = SIZE_MAX;
+
+// The stop from the table, cut short if the one added obstruction at
+// idx_obstruction lies along the way, so the table never has to change
+uint32_t jumpTableStop(const JumpTable& table, const Grid& grid, size_t idx_cell, Direction d, size_t idx_obstruction)
+{
+  uint32_t idx_stop = table[jumpTableIndex(idx_cell, d)];
+  ptrdiff_t step = gridStep(grid, d);
+  ptrdiff_t obstruction_offset = (ptrdiff_t)idx_obstruction - (ptrdiff_t)idx_cell;
+  ptrdiff_t stop_offset = (ptrdiff_t)idx_stop - (ptrdiff_t)idx_cell;
+  bool is_ahead = step > 0
+    ? obstruction_offset > 0 && obstruction_offset <= stop_offset
+    : obstruction_offset < 0 && obstruction_offset >= stop_offset;
+  if (idx_obstruction != NO_OBSTRUCTION && is_ahead && obstruction_offset % step == 0)
+    return idx_obstruction - step;
+
+  return idx_stop;
+}
+
+// Buffers for following the guard, reused between walks: a visited bit per
+// tile, and 4 bits per tile for the directions the guard has turned to there,
+// two tiles to a byte. Only the words and bytes a walk touched are cleared on
+// reset, so a short walk on a large grid stays cheap
+struct PatrolArena
+{
+  std::vector<uint64_t> visited;
+  std::vector<uint8_t> turn_masks;
+  std::vector<size_t> touched_visited; // indices into visited
+  std::vector<size_t> touched_masks; // indices into turn_masks
 };
 
-#ifdef PART_TWO
-bool guardDoesLoopWhenTurning(const Guard& guard, const std::array<Tile, GRID_SIZE * GRID_SIZE>& grid)
+PatrolArena patrolArenaBuild(size_t tile_count)
 {
-  Guard theoretical_guard{guard.position, directionTurn(guard.facing)};
-  while (positionIsInGrid(theoretical_guard.position) && theoretical_guard != guard) {
-    Position next_pos = positionNextInDirection(theoretical_guard.position, theoretical_guard.facing);
-    bool is_next_tile_obstruction = positionIsInGrid(next_pos) ? grid[positionToGridIndex(next_pos)] == OBSTRUCTION : false;
-    if (is_next_tile_obstruction) {
-      theoretical_guard.facing = directionTurn(theoretical_guard.facing);
-      continue;
-    }
+  return {std::vector<uint64_t>((tile_count + 63) / 64, 0), std::vector<uint8_t>((tile_count + 1) / 2, 0), {}, {}};
+}
 
-    theoretical_guard.position = next_pos;
-  }
+void patrolArenaReset(PatrolArena& arena)
+{
+  for (size_t idx_word: arena.touched_visited)
+    arena.visited[idx_word] = 0;
+  arena.touched_visited.clear();
 
-  return theoretical_guard == guard;
+  for (size_t idx_byte: arena.touched_masks)
+    arena.turn_masks[idx_byte] = 0;
+  arena.touched_masks.clear();
 }
-#endif
 
-int main()
+// Returns whether the tile had not been visited yet
+bool patrolArenaVisit(PatrolArena& arena, size_t idx_cell)
 {
-#ifdef USE_INPUT_FILE
-  auto stm_input = std::ifstream(INPUT_FILE);
-  if (!stm_input) {
-    std::cout << "Unable to read input file\n";
+  uint64_t& word = arena.visited[idx_cell / 64];
+  uint64_t bit = 1ull << (idx_cell % 64);
+  if (word & bit)
+    return false;
+
+  if (word == 0)
+    arena.touched_visited.push_back(idx_cell / 64);
+  word |= bit;
+  return true;
+}
+
+// Returns whether the guard had not turned to face d at the tile yet
+bool patrolArenaTurn(PatrolArena& arena, size_t idx_cell, Direction d)
+{
+  uint8_t& mask = arena.turn_masks[idx_cell / 2];
+  uint8_t bit = 1 << (d + 4 * (idx_cell % 2));
+  if (mask & bit)
+    return false;
+
+  if (mask == 0)
+    arena.touched_masks.push_back(idx_cell / 2);
+  mask |= bit;
+  return true;
+}
+
+// Follows the guard from stop to stop, with an obstruction added at
+// idx_obstruction. The guard loops once they turn at the same tile in the same
+// direction twice
+bool jumpTableDoesLoop(const JumpTable& table, const Grid& grid, const Guard& guard,
+    size_t idx_obstruction, PatrolArena& arena)
+{
+  patrolArenaReset(arena);
+  size_t idx_cell = positionToGridIndex(grid, guard.position);
+  Direction facing = guard.facing;
+  for (;;) {
+    idx_cell = jumpTableStop(table, grid, idx_cell, facing, idx_obstruction);
+    if (grid.tiles[idx_cell] == OUTSIDE)
+      return false;
+
+    facing = directionTurn(facing);
+    if (!patrolArenaTurn(arena, idx_cell, facing))
+      return true;
   }
+}
 
-#else // USE_INPUT_FILE
-  auto str_input_storage = std::string(TEST_INPUT);
-  auto stm_input = std::istringstream(str_input_storage);
-#endif // USE_INPUT_FILE
+struct GuardPath
+{
+  std::vector<Position> tiles; // in the order they are first reached
+  bool is_loop; // the guard never leaves the grid
+};
+
+// Tiles the guard walks over before leaving the grid, or starting to loop
+GuardPath guardPath(const JumpTable& table, const Grid& grid, const Guard& guard_start, PatrolArena& arena)
+{
+  patrolArenaReset(arena);
+  size_t idx_cell = positionToGridIndex(grid, guard_start.position);
+  Direction facing = guard_start.facing;
+  auto path = GuardPath{{guard_start.position}, false};
+  patrolArenaVisit(arena, idx_cell);
+
+  // one lookup finds each stop, the tiles up to it are only recorded
+  for (;;) {
+    uint32_t idx_stop = table[jumpTableIndex(idx_cell, facing)];
+    ptrdiff_t step = gridStep(grid, facing);
+    for (; idx_cell != idx_stop; ) {
+      idx_cell += step;
+      if (grid.tiles[idx_cell] != OUTSIDE && patrolArenaVisit(arena, idx_cell))
+        path.tiles.push_back(positionFromGridIndex(grid, idx_cell));
+    }
+
+    facing = directionTurn(facing);
+    if (grid.tiles[idx_cell] == OUTSIDE)
+      return path;
 
-  std::array<Tile, GRID_SIZE * GRID_SIZE> grid{};
-  Guard guard_start{};
-  {
-    auto it = std::begin(grid);
-    for (char ch{}; stm_input.get(ch); ) {
-      switch (ch) {
-        case '#':
-          *it = OBSTRUCTION;
-          it++;
-          break;
-        case '^':
-          guard_start = { positionFromGridIndex(std::distance(std::begin(grid), it)), NORTH };
-          *it = GROUND;
-          it++;
-          break;
-        case '\n':
-          break;
-        default:
-          *it = GROUND;
-          it++;
-          break;
+    if (!patrolArenaTurn(arena, idx_cell, facing)) {
+      path.is_loop = true;
+      return path;
+    }
+  }
+}
+
+#if defined(PART_TWO) || defined(BENCHMARK)
+#ifndef PARALLEL_THREADS
+#define PARALLEL_THREADS std::thread::hardware_concurrency()
+#endif // !PARALLEL_THREADS
+
+// Counts the candidate tiles where an added obstruction makes the guard loop.
+// One thread per arena takes candidates in turn, sharing the grid and jump
+// table. The arenas are built by the caller, as on a large grid zeroing them
+// costs more than many walks
+long obstructionCountLoops(const JumpTable& table, const Grid& grid, const Guard& guard_start,
+    std::span<const Position> candidates, std::span<PatrolArena> arenas)
+{
+  size_t thread_count = std::min(arenas.size(), std::max<size_t>(1, candidates.size()));
+
+  auto next_candidate = std::atomic<size_t>{0};
+  auto thread_counts = std::vector<long>(thread_count, 0);
+  auto threads = std::vector<std::thread>{};
+  for (size_t idx_thread = 0; idx_thread < thread_count; ++idx_thread) {
+    threads.emplace_back([&, idx_thread]() {
+      auto& scratch_arena = arenas[idx_thread];
+      long count = 0;
+      for (size_t idx = next_candidate++; idx < candidates.size(); idx = next_candidate++) {
+        size_t idx_obstruction = positionToGridIndex(grid, candidates[idx]);
+        count += jumpTableDoesLoop(table, grid, guard_start, idx_obstruction, scratch_arena);
       }
+      thread_counts[idx_thread] = count;
+    });
+  }
+
+  for (auto& thread: threads)
+    thread.join();
+
+  return std::accumulate(std::begin(thread_counts), std::end(thread_counts), 0l);
+}
+#endif // PART_TWO || BENCHMARK
+
+#ifdef BENCHMARK
+// obstructions along each generated path that are tested
+static constexpr size_t BENCHMARK_CANDIDATES = 20000;
+
+// Random map of obstructions at about the density of the input, with the
+// guard facing north from the middle, as text to load. At that density the
+// guard soon starts to loop, so the guard is walked here too. Whenever they
+// turn somewhere a second time, the obstruction they turn at is removed and
+// the walk starts over, until they leave the map
+std::string benchmarkGenerateMap(long side, std::mt19937_64& rng_engine)
+{
+  auto str_map = std::string((side + 1) * side, '.');
+  for (long y = 0; y < side; ++y) {
+    char *line = str_map.data() + y * (side + 1);
+    for (long x = 0; x < side; ++x) {
+      if (rng_engine() % 20 == 0)
+        line[x] = '#';
     }
+    line[side] = '\n';
   }
 
-  Guard guard{guard_start};
-  auto fn_is_guard_finished = [guard_start](const Guard& g) -> bool {
-    if (g.position == guard_start.position && g.facing == guard_start.facing)
-      return true;
+  static constexpr long STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+  long x = side / 2, y = side / 2;
+  int facing = NORTH;
+  str_map[y * (side + 1) + x] = '^';
+
+  auto turn_states = std::unordered_set<uint64_t>{};
+  for (;;) {
+    long x_next = x + STEPS[facing][0], y_next = y + STEPS[facing][1];
+    if (x_next < 0 || x_next >= side || y_next < 0 || y_next >= side)
+      break;
+
+    char& ahead = str_map[y_next * (side + 1) + x_next];
+    if (ahead != '#') {
+      x = x_next;
+      y = y_next;
+      continue;
+    }
+
+    // the guard turned at this obstruction on the way here too, so that
+    // part of the walk changes with it
+    if (!turn_states.insert((uint64_t)(y * side + x) * 4 + facing).second) {
+      ahead = '.';
+      turn_states.clear();
+      x = side / 2;
+      y = side / 2;
+      facing = NORTH;
+      continue;
+    }
+    facing = (facing + 1) % 4;
+  }
+
+  return str_map;
+}
 
-    return !positionIsInGrid(g.position);
+void progRunBenchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto fn_millis = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
   };
 
-#ifndef PART_TWO
-  std::set<Position> visited_positions{guard.position};
-#else // !PART_TWO
-  long answer = 0;
-#endif // !PART_TWO
+  auto rng_engine = std::mt19937_64{6};
+  for (long side: {1000l, 2000l, 5000l, 10000l}) {
+    auto str_map = benchmarkGenerateMap(side, rng_engine);
+    std::cout << side << "x" << side << " map\n";
+
+    auto time_start = Clock::now();
+    auto parsed = gridParse(str_map);
+    std::cout << "  load:         " << fn_millis(Clock::now() - time_start) << " ms\n";
+    str_map = std::string{};
+    if (!parsed)
+      continue;
+    const auto& [grid, guard_start] = *parsed;
 
-  do {
-    Position next_pos = positionNextInDirection(guard.position, guard.facing);
+    time_start = Clock::now();
+    auto table = jumpTableBuild(grid);
+    std::cout << "  jump table:   " << fn_millis(Clock::now() - time_start) << " ms\n";
 
-#ifdef PART_TWO
-    if (guardDoesLoopWhenTurning(guard, grid)) {
-      ++answer;
-    }
+    auto arenas = std::vector<PatrolArena>{};
+    for (unsigned idx_thread = 0; idx_thread < std::max(2u, std::thread::hardware_concurrency()); ++idx_thread)
+      arenas.push_back(patrolArenaBuild(grid.tiles.size()));
 
-#endif // PART_TWO
-    bool is_next_tile_obstruction = positionIsInGrid(next_pos) ? grid[positionToGridIndex(next_pos)] == OBSTRUCTION : false;
-    if (is_next_tile_obstruction) {
-      guard.facing = directionTurn(guard.facing);
+    time_start = Clock::now();
+    auto path = guardPath(table, grid, guard_start, arenas.front());
+    std::cout << "  path:         " << fn_millis(Clock::now() - time_start) << " ms ("
+      << path.tiles.size() << " tiles" << (path.is_loop ? ", loops" : "") << ")\n";
+    if (path.is_loop)
       continue;
+
+    auto candidates = std::span<const Position>(path.tiles).subspan(1);
+    candidates = candidates.first(std::min(candidates.size(), BENCHMARK_CANDIDATES));
+    for (unsigned thread_count: {1u, std::max(2u, std::thread::hardware_concurrency())}) {
+      time_start = Clock::now();
+      long loop_count = obstructionCountLoops(table, grid, guard_start, candidates,
+          std::span(arenas).first(thread_count));
+      auto millis = fn_millis(Clock::now() - time_start);
+      std::cout << "  " << candidates.size() << " obstructions, " << thread_count << " threads: "
+        << millis << " ms (" << loop_count << " loops, "
+        << (millis > 0 ? candidates.size() / millis * 1000 : 0) << " obstructions/s)\n";
     }
+  }
+}
+#endif // BENCHMARK
 
-#ifndef PART_TWO
-    visited_positions.insert(guard.position);
-    guard.position = next_pos;
+int main()
+{
+#ifdef BENCHMARK
+  progRunBenchmark();
+  return 0;
+#endif // BENCHMARK
 
-#endif // !PART_TWO
-  } while (!fn_is_guard_finished(guard));
+#ifdef USE_INPUT_FILE
+  auto mapped_input = MappedFile(INPUT_FILE);
+  if (!mapped_input.isOpen()) {
+    std::cout << "Unable to read input file\n";
+    return 1;
+  }
+  auto parsed = gridParse(mapped_input.contents());
+
+#else // USE_INPUT_FILE
+  auto parsed = gridParse(TEST_INPUT);
+#endif // USE_INPUT_FILE
+
+  if (!parsed)
+    return 1;
+
+  const auto& [grid, guard_start] = *parsed;
+  auto table = jumpTableBuild(grid);
+  auto arena = patrolArenaBuild(grid.tiles.size());
+  auto path = guardPath(table, grid, guard_start, arena);
 
 #ifndef PART_TWO
-  long answer = visited_positions.size();
+  long answer = path.tiles.size();
+
+#else // !PART_TWO
+  // an obstruction off the path would also leave the guard looping, so the
+  // path alone says nothing about where to place one
+  if (path.is_loop) {
+    std::cout << "The guard loops without an added obstruction\n";
+    return 1;
+  }
+
+  // the path starts where the guard stands, which cannot be obstructed
+  auto candidates = std::span<const Position>(path.tiles).subspan(1);
+  auto arenas = std::vector<PatrolArena>{std::move(arena)};
+  for (unsigned idx_thread = 1; idx_thread < PARALLEL_THREADS; ++idx_thread)
+    arenas.push_back(patrolArenaBuild(grid.tiles.size()));
+
+  auto time_start = std::chrono::steady_clock::now();
+  long answer = obstructionCountLoops(table, grid, guard_start, candidates, arenas);
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+  std::cout << "Tested " << candidates.size() << " obstructions in " << seconds * 1000 << " ms ("
+    << (seconds > 0 ? candidates.size() / seconds : 0) << " obstructions/s)\n";
 #endif // !PART_TWO
 
   std::cout << "Answer: " << answer << "\n";
@@ -5,17 +5,23 @@
  * ## Part 1
  *
  * 1. Parse equations
- * 2. Create the equations results by incrementally performing adding and
- *    multiplication on a branching set of numbers for each operand
- * 3. Search through the final equation results for the expected result
- * 4. If the expected result is found, this equation is valid
+ * 2. Starting from the expected result and the last operand, undo each
+ *    operator that could have produced the result: subtract the operand, or
+ *    divide by it if it divides the result exactly
+ * 3. Repeat with what is left and the operand before, until one operand is left
+ * 4. If that operand is what is left of the result, this equation is valid
  * 5. Take the sum of all valid equations
  *
+ * Working backwards stops most branches after one operand, where building
+ * every result forwards, as the first version of this did, grows as 2^n. The
+ * forward version is kept to check the backward one against.
+ *
  * ## Part 2
  *
  * 1. Parse equations
- * 2. Create the equations results as above, only with another concatenation
- *    operator (explained below)
+ * 2. Work back from the expected result as above, also undoing a
+ *    concatenation (explained below) when the result ends with the operand's
+ *    digits, by removing them
  * 3. Search for expected result; if found, equation is valid
  * 4. Take the sum of all valid equations
  *
@@ -40,7 +46,7 @@
 
 #include "share.h"
 
-#include <fstream>
+#include <spanstream>
 #include <sstream>
 #include <ranges>
 #include <charconv>
@@ -49,6 +55,8 @@
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <span>
+#include <random>
 
 static constexpr const char * INPUT_FILE = "7.txt";
 
@@ -140,17 +148,82 @@ std::vector<uint64_t> equationResultsAddOperandWithConcat(const std::vector<uint
   return new_result;
 }
 
-using namespace std::string_view_literals; // ""sv
+// Breadth-first: every result of the operands, then whether it is among them
+bool equationIsSolvableBreadthFirst(const Equation& equation, bool with_concat)
+{
+  auto equation_results = std::vector<uint64_t>{};
+  for (const auto& operand: equation.operands) {
+    equation_results = with_concat
+      ? equationResultsAddOperandWithConcat(equation_results, operand)
+      : equationResultsAddOperand(equation_results, operand);
+  }
+
+  return std::ranges::find(equation_results, equation.result) != std::end(equation_results);
+}
+
+// Depth-first from the result back through the operands, last first. The last
+// operator can only be `+` if the result is at least the operand, `*` if the
+// operand divides the result, and `||` if the result ends in the operand's
+// digits, so most branches stop at once
+bool equationIsSolvableFrom(uint64_t target, std::span<const uint64_t> operands, bool with_concat)
+{
+  uint64_t operand = operands.back();
+  if (operands.size() == 1)
+    return target == operand;
+
+  auto operands_before = operands.first(operands.size() - 1);
+  if (target >= operand && equationIsSolvableFrom(target - operand, operands_before, with_concat))
+    return true;
+
+  // anything times zero is zero
+  if (operand == 0 ? target == 0 : target % operand == 0 && equationIsSolvableFrom(target / operand, operands_before, with_concat))
+    return true;
+
+  if (with_concat) {
+    uint64_t place = 1; // as in concat, zero has no digits
+    for (uint64_t tmp = operand; tmp > 0; tmp /= 10)
+      place *= 10;
+
+    if (target >= operand && (target - operand) % place == 0
+        && equationIsSolvableFrom((target - operand) / place, operands_before, with_concat))
+      return true;
+  }
+
+  return false;
+}
+
+bool equationIsSolvable(const Equation& equation, bool with_concat)
+{
+  return !equation.operands.empty() && equationIsSolvableFrom(equation.result, equation.operands, with_concat);
+}
 
-template <typename T>
-void vecPrint(const std::vector<T>& vec, std::string_view sep = ", "sv)
+// The depth-first solver must agree with the breadth-first one, on equations
+// that have a solution and ones that mostly do not
+bool testSolverMatchesBreadthFirst()
 {
-  for (auto it = std::begin(vec); it != std::end(vec); ++it) {
-    std::cout << (*it);
-    if (it + 1 != std::end(vec)) {
-      std::cout << sep;
+  auto rng_engine = std::mt19937_64{7};
+  auto dist_length = std::uniform_int_distribution<size_t>{1, 8};
+  auto dist_operand = std::uniform_int_distribution<uint64_t>{0, 30};
+
+  for (int trial = 0; trial < 20000; ++trial) {
+    auto equation = Equation{0, std::vector<uint64_t>(dist_length(rng_engine))};
+    for (auto& operand: equation.operands)
+      operand = dist_operand(rng_engine);
+
+    auto equation_results = std::vector<uint64_t>{};
+    for (const auto& operand: equation.operands)
+      equation_results = equationResultsAddOperandWithConcat(equation_results, operand);
+    equation.result = trial % 2
+      ? equation_results[rng_engine() % equation_results.size()]
+      : rng_engine() % 100000;
+
+    for (bool with_concat: {false, true}) {
+      if (equationIsSolvable(equation, with_concat) != equationIsSolvableBreadthFirst(equation, with_concat))
+        return false;
     }
   }
+
+  return true;
 }
 
 uint64_t calculateAnswerPart1(std::basic_istream<char>& stm_input)
@@ -159,13 +232,7 @@ uint64_t calculateAnswerPart1(std::basic_istream<char>& stm_input)
 
   uint64_t answer = 0;
   for (const auto& equation: equations) {
-    auto equation_results = std::vector<uint64_t>{};
-    for (const auto& operand: equation.operands) {
-      equation_results = std::move(equationResultsAddOperand(equation_results, operand));
-    }
-
-    auto it_result = std::ranges::find(equation_results, equation.result);
-    if (it_result != std::end(equation_results)) {
+    if (equationIsSolvable(equation, false)) {
       answer += equation.result;
     }
   }
@@ -179,13 +246,7 @@ uint64_t calculateAnswerPart2(std::basic_istream<char>& stm_input)
 
   uint64_t answer = 0;
   for (const auto& equation: equations) {
-    auto equation_results = std::vector<uint64_t>{};
-    for (const auto& operand: equation.operands) {
-      equation_results = std::move(equationResultsAddOperandWithConcat(equation_results, operand));
-    }
-
-    auto it_result = std::ranges::find(equation_results, equation.result);
-    if (it_result != std::end(equation_results)) {
+    if (equationIsSolvable(equation, true)) {
       answer += equation.result;
     }
   }
@@ -195,6 +256,11 @@ uint64_t calculateAnswerPart2(std::basic_istream<char>& stm_input)
 
 int main()
 {
+  if (!testSolverMatchesBreadthFirst()) {
+    std::cout << "Solver test was not successful\n";
+    return 0;
+  }
+
   std::cout << "Part 1\n======\n";
 
   {
@@ -211,11 +277,12 @@ int main()
   }
 
   {
-    auto stm_file_input = std::ifstream{INPUT_FILE};
-    if (!stm_file_input) {
+    auto mapped_file_input = MappedFile{INPUT_FILE};
+    if (!mapped_file_input.isOpen()) {
       std::cout << "Unable to read input file\n";
       return -1;
     }
+    auto stm_file_input = std::ispanstream{mapped_file_input.contents()};
 
     uint64_t answer = calculateAnswerPart1(stm_file_input);
 
@@ -238,11 +305,12 @@ int main()
   }
 
   {
-    auto stm_file_input = std::ifstream{INPUT_FILE};
-    if (!stm_file_input) {
+    auto mapped_file_input = MappedFile{INPUT_FILE};
+    if (!mapped_file_input.isOpen()) {
       std::cout << "Unable to read input file\n";
       return -1;
     }
+    auto stm_file_input = std::ispanstream{mapped_file_input.contents()};
 
     uint64_t answer = calculateAnswerPart2(stm_file_input);
 
@@ -42,7 +42,7 @@
 
 #include "share.h"
 
-#include <fstream>
+#include <spanstream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -306,11 +306,12 @@ int main()
   }
 
   {
-    auto stm_file_input = std::ifstream{INPUT_FILE};
-    if (!stm_file_input) {
+    auto mapped_file_input = MappedFile{INPUT_FILE};
+    if (!mapped_file_input.isOpen()) {
       std::cout << "Unable to read input file\n";
       return -1;
     }
+    auto stm_file_input = std::ispanstream{mapped_file_input.contents()};
 
     uint64_t answer = calculateAnswerPart1(stm_file_input, BIG_GRID_SIZE);
     std::cout << "Final answer: " << answer << "\n";
@@ -331,11 +332,12 @@ int main()
   }
 
   {
-    auto stm_file_input = std::ifstream{INPUT_FILE};
-    if (!stm_file_input) {
+    auto mapped_file_input = MappedFile{INPUT_FILE};
+    if (!mapped_file_input.isOpen()) {
       std::cout << "Unable to read input file\n";
       return -1;
     }
+    auto stm_file_input = std::ispanstream{mapped_file_input.contents()};
 
     uint64_t answer = calculateAnswerPart2(stm_file_input, BIG_GRID_SIZE);
     std::cout << "Final answer: " << answer << "\n";
@@ -1,6 +1,7 @@
 /* Header for shared components across Advent of Code */
 
 #ifndef _SHARED_H
+#define _SHARED_H
 
 #include <iostream>
 #include <string>
@@ -8,6 +9,14 @@
 #include <utility>
 #include <cstdint>
 #include <vector>
+#include <charconv>
+#include <limits>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using Stm = std::basic_istream<char>;
 
@@ -16,15 +25,70 @@ Stm& stmNext(
     std::string *str = nullptr,
     char delim = '\n')
 {
-  if (str) str->erase();
-  for (char c{}; stream.get(c); )
-  {
-    if (c == delim) break;
-    if (str) *(str) += c;
+  if (str) {
+    str->erase();
+    std::getline(stream, *str, delim);
   }
+  else
+    stream.ignore(std::numeric_limits<std::streamsize>::max(), delim);
+
+  // a last line without delim still fails the stream, as get() would
+  if (stream.eof())
+    stream.setstate(std::ios::failbit);
   return stream;
 }
 
+// Read-only view of a whole file, mapped if possible and read otherwise
+class MappedFile
+{
+public:
+  explicit MappedFile(const char *path)
+  {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return;
+
+    struct stat file_stat{};
+    if (::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      void *mapping = ::mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        m_mapping = mapping;
+        m_mapping_size = file_stat.st_size;
+        m_contents = {(const char *)mapping, m_mapping_size};
+      }
+    }
+
+    if (!m_mapping) {
+      char buffer[1 << 16];
+      for (ssize_t n; (n = ::read(fd, buffer, sizeof buffer)) > 0; )
+        m_fallback.append(buffer, n);
+      m_contents = m_fallback;
+    }
+
+    m_is_open = true;
+    ::close(fd);
+  }
+
+  ~MappedFile()
+  {
+    if (m_mapping)
+      ::munmap(m_mapping, m_mapping_size);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool isOpen() const { return m_is_open; }
+  std::string_view contents() const { return m_contents; }
+
+private:
+  bool m_is_open = false;
+  void *m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+  std::string m_fallback{};
+  std::string_view m_contents{};
+};
+
 constexpr
 std::pair<std::string_view, std::string_view>
 svSplitFirst(std::string_view sv, char separator) noexcept